@@ -0,0 +1,157 @@
+# Compile-throughput benchmark driver. Run in script mode:
+#   cmake -DDHACC=<DH-acc> -DSRCGEN=<srcgen> -DBINARY_DIR=<work dir> \
+#      [-DLANGS=ds;c] [-DDIMENSIONS=functions;...] -P compile.cmake
+#
+# For each language and input dimension, srcgen writes a ladder of programs
+# where only that dimension doubles at each step. Each is compiled and linked
+# with --time-report, and the time and peak memory of every phase are written
+# to compile-results.txt. A phase whose time grows by more than 2.8 times over
+# the last doubling, about n^1.5, is reported as superlinear.
+
+
+
+if(NOT LANGS)
+   set(LANGS ds c)
+endif()
+
+if(NOT DIMENSIONS)
+   set(DIMENSIONS
+      functions globals depth enumerators cases macros members structs strings)
+endif()
+
+# Every dimension not being scaled is held at these.
+set(BASE
+   --functions 20 --globals 20 --depth 2 --enumerators 20 --cases 8
+   --macros 20 --members 8 --structs 4 --strings 20)
+
+set(LADDER_functions   100 200 400 800)
+set(LADDER_globals     250 500 1000 2000)
+set(LADDER_depth       8 16 32 64)
+set(LADDER_enumerators 500 1000 2000 4000)
+set(LADDER_cases       64 128 256 512)
+set(LADDER_macros      250 500 1000 2000)
+set(LADDER_members     64 128 256 512)
+set(LADDER_structs     100 200 400 800)
+set(LADDER_strings     500 1000 2000 4000)
+
+# Phases shorter than this, in microseconds, are too noisy to judge.
+set(MIN_USEC 100000)
+
+set(RESULTS ${BINARY_DIR}/compile-results.txt)
+
+foreach(var DHACC SRCGEN BINARY_DIR)
+   if(NOT ${var})
+      message(FATAL_ERROR "${var} not set")
+   endif()
+endforeach()
+
+
+
+# Runs a command, stopping on failure.
+function(RUN_CHECKED)
+   execute_process(COMMAND ${ARGN} RESULT_VARIABLE result ERROR_VARIABLE err)
+
+   if(NOT result EQUAL 0)
+      message(FATAL_ERROR "${ARGN}\n${err}")
+   endif()
+endfunction()
+
+# Converts seconds with six decimals to integer microseconds.
+function(TO_USEC var seconds)
+   string(REPLACE "." "" usec ${seconds})
+   string(REGEX MATCH "[1-9][0-9]*$" usec ${usec})
+
+   if(NOT usec)
+      set(usec 0)
+   endif()
+
+   set(${var} ${usec} PARENT_SCOPE)
+endfunction()
+
+# Appends the phases of a time report to the results and records each one's
+# time as USEC_<stage>_<phase>_<step>.
+function(READ_REPORT report stage prefix step)
+   file(STRINGS ${report} lines REGEX "^[^#]")
+
+   foreach(line ${lines})
+      string(REGEX REPLACE " +" ";" fields "${line}")
+      list(GET fields 0 phase)
+      list(GET fields 1 seconds)
+      list(GET fields 2 peak)
+
+      file(APPEND ${RESULTS} "${prefix} ${stage} ${phase} ${seconds} ${peak}\n")
+
+      TO_USEC(usec ${seconds})
+      set(USEC_${stage}_${phase}_${step} ${usec} PARENT_SCOPE)
+      set(SECONDS_${stage}_${phase}_${step} ${seconds} PARENT_SCOPE)
+
+      list(APPEND phases ${phase})
+   endforeach()
+
+   set(PHASES_${stage} ${phases} PARENT_SCOPE)
+endfunction()
+
+
+
+file(MAKE_DIRECTORY ${BINARY_DIR}/compile)
+file(WRITE ${RESULTS} "# lang dimension value stage phase seconds peak-KiB\n")
+
+set(superlinear 0)
+
+foreach(lang ${LANGS})
+   foreach(dim ${DIMENSIONS})
+      message(STATUS "${lang} ${dim}")
+
+      set(step 0)
+      foreach(value ${LADDER_${dim}})
+         set(base ${BINARY_DIR}/compile/${lang}-${dim}-${value})
+
+         RUN_CHECKED(${SRCGEN} ${BASE} --${dim} ${value} --lang ${lang}
+            -o ${base}.${lang})
+         RUN_CHECKED(${DHACC} -Z --time-report ${base}.compile -c
+            -o ${base}.o ${base}.${lang})
+         RUN_CHECKED(${DHACC} -Z --time-report ${base}.link
+            -o ${base}.lmp ${base}.o)
+
+         READ_REPORT(${base}.compile compile "${lang} ${dim} ${value}" ${step})
+         READ_REPORT(${base}.link    link    "${lang} ${dim} ${value}" ${step})
+
+         set(last ${step})
+         math(EXPR step "${step} + 1")
+      endforeach()
+
+      # Judge the last doubling.
+      math(EXPR prev "${last} - 1")
+
+      foreach(stage compile link)
+         foreach(phase ${PHASES_${stage}})
+            set(usec ${USEC_${stage}_${phase}_${last}})
+            set(usecPrev ${USEC_${stage}_${phase}_${prev}})
+
+            if(usec LESS MIN_USEC OR NOT usecPrev GREATER 0)
+               continue()
+            endif()
+
+            math(EXPR ratio "${usec} * 10 / ${usecPrev}")
+            set(times)
+            foreach(i RANGE ${last})
+               list(APPEND times ${SECONDS_${stage}_${phase}_${i}})
+            endforeach()
+            string(REPLACE ";" " " times "${times}")
+
+            if(ratio GREATER 28)
+               message("superlinear: ${lang} ${dim} ${stage} ${phase}: ${times}")
+               math(EXPR superlinear "${superlinear} + 1")
+            else()
+               message("${lang} ${dim} ${stage} ${phase}: ${times}")
+            endif()
+         endforeach()
+      endforeach()
+   endforeach()
+endforeach()
+
+message(STATUS "Results written to ${RESULTS}")
+message(STATUS "${superlinear} superlinear phases")
+
+# EOF
+
@@ -0,0 +1,122 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Benchmark: bytecode dispatch.
+//
+// Interprets a stream of pseudo-random opcodes with one switch over a dense
+// range of 60 cases.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static int Counts[4];
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// BenchDense
+//
+void BenchDense(void) __attribute__((__script__(enter)))
+{
+   unsigned seed = 1;
+   int i, acc = 0, x = 1;
+
+   for(i = 0; i < 2000; ++i)
+   {
+      seed = seed * 1103515245u + 12345u;
+
+      switch((int)(seed >> 16 & 0x7FFF) % 60)
+      {
+      case  0: acc = acc * 4 + x; ++Counts[0]; break;
+      case  1: acc ^= x << 10; ++Counts[1]; break;
+      case  2: acc += x * 9; ++Counts[2]; break;
+      case  3: acc -= 3; ++Counts[3]; break;
+      case  4: acc = (acc >> 3) + 6; ++Counts[0]; break;
+      case  5: x += 10; ++Counts[1]; break;
+      case  6: acc = acc * 8 + x; ++Counts[2]; break;
+      case  7: acc ^= x << 11; ++Counts[3]; break;
+      case  8: acc += x * 10; ++Counts[0]; break;
+      case  9: acc -= 2; ++Counts[1]; break;
+      case 10: acc = (acc >> 3) + 10; ++Counts[2]; break;
+      case 11: x += 1; ++Counts[3]; break;
+      case 12: acc = acc * 8 + x; ++Counts[0]; break;
+      case 13: acc ^= x << 5; ++Counts[1]; break;
+      case 14: acc += x * 9; ++Counts[2]; break;
+      case 15: acc -= 4; ++Counts[3]; break;
+      case 16: acc = (acc >> 3) + 4; ++Counts[0]; break;
+      case 17: x += 12; ++Counts[1]; break;
+      case 18: acc = acc * 8 + x; ++Counts[2]; break;
+      case 19: acc ^= x << 9; ++Counts[3]; break;
+      case 20: acc += x * 9; ++Counts[0]; break;
+      case 21: acc -= 8; ++Counts[1]; break;
+      case 22: acc = (acc >> 3) + 7; ++Counts[2]; break;
+      case 23: x += 11; ++Counts[3]; break;
+      case 24: acc = acc * 3 + x; ++Counts[0]; break;
+      case 25: acc ^= x << 4; ++Counts[1]; break;
+      case 26: acc += x * 11; ++Counts[2]; break;
+      case 27: acc -= 3; ++Counts[3]; break;
+      case 28: acc = (acc >> 3) + 9; ++Counts[0]; break;
+      case 29: x += 7; ++Counts[1]; break;
+      case 30: acc = acc * 12 + x; ++Counts[2]; break;
+      case 31: acc ^= x << 1; ++Counts[3]; break;
+      case 32: acc += x * 11; ++Counts[0]; break;
+      case 33: acc -= 13; ++Counts[1]; break;
+      case 34: acc = (acc >> 3) + 2; ++Counts[2]; break;
+      case 35: x += 3; ++Counts[3]; break;
+      case 36: acc = acc * 13 + x; ++Counts[0]; break;
+      case 37: acc ^= x << 10; ++Counts[1]; break;
+      case 38: acc += x * 1; ++Counts[2]; break;
+      case 39: acc -= 5; ++Counts[3]; break;
+      case 40: acc = (acc >> 3) + 13; ++Counts[0]; break;
+      case 41: x += 1; ++Counts[1]; break;
+      case 42: acc = acc * 5 + x; ++Counts[2]; break;
+      case 43: acc ^= x << 8; ++Counts[3]; break;
+      case 44: acc += x * 10; ++Counts[0]; break;
+      case 45: acc -= 12; ++Counts[1]; break;
+      case 46: acc = (acc >> 3) + 7; ++Counts[2]; break;
+      case 47: x += 12; ++Counts[3]; break;
+      case 48: acc = acc * 13 + x; ++Counts[0]; break;
+      case 49: acc ^= x << 7; ++Counts[1]; break;
+      case 50: acc += x * 7; ++Counts[2]; break;
+      case 51: acc -= 12; ++Counts[3]; break;
+      case 52: acc = (acc >> 3) + 13; ++Counts[0]; break;
+      case 53: x += 10; ++Counts[1]; break;
+      case 54: acc = acc * 8 + x; ++Counts[2]; break;
+      case 55: acc ^= x << 3; ++Counts[3]; break;
+      case 56: acc += x * 6; ++Counts[0]; break;
+      case 57: acc -= 2; ++Counts[1]; break;
+      case 58: acc = (acc >> 3) + 1; ++Counts[2]; break;
+      case 59: x += 3; ++Counts[3]; break;
+      }
+   }
+
+   printf("dense %i %i %i %i %i\n", acc, Counts[0], Counts[1], Counts[2],
+      Counts[3]);
+}
+
+// EOF
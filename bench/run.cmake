@@ -0,0 +1,201 @@
+# Runtime benchmark driver. Run in script mode:
+#   cmake -DDHACC=<DH-acc> -DACSVM=<acsvm> -DSOURCE_DIR=<repo> \
+#      -DBINARY_DIR=<work dir> [-DUPDATE_BASELINE=ON] -P run.cmake
+#
+# Every workload is compiled and linked, along with lib, under each option
+# configuration and run in acsvm. The executed instruction count and lump size
+# of each are written to results.txt and compared against baseline.txt. Any
+# increase is an error, as is output that differs from the unoptimized build.
+
+
+
+# Workloads, each a single source file in this directory.
+set(WORKLOADS
+   arith.ds
+   dense.c
+   malloc.ds
+   printf.ds
+   sort.ds
+   state.c
+   string.ds
+   struct.c
+)
+
+set(LIBS ctype stdio stdlib string)
+
+# Option configurations. The first is the reference for output. Each other one
+# changes a single setting from the defaults, so a regression points at the
+# option responsible without building the full cross product.
+set(CONFIGS
+   none
+   default
+   no-opt-branch-flip
+   no-opt-frame
+   no-opt-icf
+   no-opt-imm
+   no-opt-inline
+   no-opt-printf
+   no-opt-pushdrop
+   no-opt-pushpushswap
+   no-opt-register
+   no-opt-switch-dense
+   no-opt-switch-tree
+   no-opt-tail
+   no-string-fold
+   gc-sections
+   opt-math-nop
+   opt-nop
+   data-layout-size
+   data-layout-use
+   ACSe
+)
+
+set(FLAGS_none
+   --no-opt-branch-flip --no-opt-frame --no-opt-icf --no-opt-imm --no-opt-inline
+   --no-opt-printf --no-opt-pushdrop --no-opt-pushpushswap --no-opt-register
+   --no-opt-switch-dense --no-opt-switch-tree --no-opt-tail --no-string-fold)
+set(FLAGS_default "")
+set(FLAGS_data-layout-size --data-layout=size)
+set(FLAGS_data-layout-use  --data-layout=use)
+set(FLAGS_ACSe             --output-type=ACSe)
+
+foreach(config ${CONFIGS})
+   if(NOT DEFINED FLAGS_${config})
+      set(FLAGS_${config} --${config})
+   endif()
+endforeach()
+
+set(BASELINE ${SOURCE_DIR}/bench/baseline.txt)
+set(RESULTS  ${BINARY_DIR}/results.txt)
+
+foreach(var DHACC ACSVM SOURCE_DIR BINARY_DIR)
+   if(NOT ${var})
+      message(FATAL_ERROR "${var} not set")
+   endif()
+endforeach()
+
+
+
+# Runs a command, stopping on failure.
+function(RUN_CHECKED)
+   execute_process(COMMAND ${ARGN} RESULT_VARIABLE result ERROR_VARIABLE err)
+
+   if(NOT result EQUAL 0)
+      message(FATAL_ERROR "${ARGN}\n${err}")
+   endif()
+endfunction()
+
+# Loads the baseline into BASE_<config>_<workload> variables.
+function(READ_BASELINE)
+   if(NOT EXISTS ${BASELINE})
+      return()
+   endif()
+
+   file(STRINGS ${BASELINE} lines REGEX "^[^#]")
+
+   foreach(line ${lines})
+      string(REGEX REPLACE " +" ";" fields "${line}")
+      list(GET fields 0 config)
+      list(GET fields 1 workload)
+      list(GET fields 2 instructions)
+      list(GET fields 3 bytes)
+      set(BASE_${config}_${workload} "${instructions};${bytes}" PARENT_SCOPE)
+   endforeach()
+endfunction()
+
+
+
+READ_BASELINE()
+
+file(WRITE ${RESULTS} "# config workload instructions bytes\n")
+
+set(regressions 0)
+set(improvements 0)
+
+foreach(config ${CONFIGS})
+   set(dir ${BINARY_DIR}/${config})
+   file(MAKE_DIRECTORY ${dir}/lib)
+
+   message(STATUS "${config}")
+
+   set(libObjects)
+   foreach(lib ${LIBS})
+      RUN_CHECKED(${DHACC} -Z ${FLAGS_${config}} -I ${SOURCE_DIR}/inc
+         -c -o ${dir}/lib/${lib}.o ${SOURCE_DIR}/lib/${lib}.ds)
+      list(APPEND libObjects ${dir}/lib/${lib}.o)
+   endforeach()
+
+   foreach(source ${WORKLOADS})
+      string(REGEX REPLACE "\\.[^.]*$" "" workload ${source})
+
+      set(object ${dir}/${workload}.o)
+      set(lump   ${dir}/${workload}.lmp)
+      set(report ${dir}/${workload}.report)
+
+      RUN_CHECKED(${DHACC} -Z ${FLAGS_${config}} -I ${SOURCE_DIR}/inc
+         -c -o ${object} ${SOURCE_DIR}/bench/${source})
+      RUN_CHECKED(${DHACC} -Z ${FLAGS_${config}} -o ${lump} ${object}
+         ${libObjects})
+
+      execute_process(COMMAND ${ACSVM} --max-instructions 50000000
+         --report ${report} ${lump}
+         RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE err)
+
+      if(NOT result EQUAL 0)
+         message(FATAL_ERROR "${config} ${workload}: ${err}")
+      endif()
+
+      # Output must not depend on options.
+      if(config STREQUAL "none")
+         set(OUTPUT_${workload} "${output}")
+      elseif(NOT output STREQUAL OUTPUT_${workload})
+         message(FATAL_ERROR "${config} ${workload}: output differs from none:\n"
+            "${output}\nexpected:\n${OUTPUT_${workload}}")
+      endif()
+
+      file(STRINGS ${report} header LIMIT_COUNT 1)
+      string(REGEX REPLACE "^.*: ([0-9]+) instructions.*$" "\\1" instructions
+         "${header}")
+
+      # file(SIZE) is too new, so count the bytes from a hex dump.
+      file(READ ${lump} hex HEX)
+      string(LENGTH "${hex}" bytes)
+      math(EXPR bytes "${bytes} / 2")
+
+      file(APPEND ${RESULTS} "${config} ${workload} ${instructions} ${bytes}\n")
+
+      if(DEFINED BASE_${config}_${workload})
+         list(GET BASE_${config}_${workload} 0 baseInstructions)
+         list(GET BASE_${config}_${workload} 1 baseBytes)
+
+         if(instructions GREATER baseInstructions OR bytes GREATER baseBytes)
+            message("regression: ${config} ${workload}: "
+               "${baseInstructions} -> ${instructions} instructions, "
+               "${baseBytes} -> ${bytes} bytes")
+            math(EXPR regressions "${regressions} + 1")
+         elseif(instructions LESS baseInstructions OR bytes LESS baseBytes)
+            message("improvement: ${config} ${workload}: "
+               "${baseInstructions} -> ${instructions} instructions, "
+               "${baseBytes} -> ${bytes} bytes")
+            math(EXPR improvements "${improvements} + 1")
+         endif()
+      elseif(NOT UPDATE_BASELINE)
+         message("new: ${config} ${workload}: ${instructions} instructions, "
+            "${bytes} bytes")
+      endif()
+   endforeach()
+endforeach()
+
+message(STATUS "Results written to ${RESULTS}")
+
+if(UPDATE_BASELINE)
+   configure_file(${RESULTS} ${BASELINE} COPYONLY)
+   message(STATUS "Baseline updated")
+elseif(regressions GREATER 0)
+   message(FATAL_ERROR "${regressions} regressions against ${BASELINE}")
+elseif(improvements GREATER 0)
+   message(STATUS "${improvements} improvements, consider updating the baseline")
+endif()
+
+# EOF
+
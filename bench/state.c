@@ -0,0 +1,150 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Benchmark: switch-driven state machine.
+//
+// Scans a small expression language, switching densely on the state and
+// sparsely on the character class.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+enum State
+{
+   ST_START,
+   ST_NUMBER,
+   ST_NAME,
+   ST_OPER,
+   ST_COMMENT,
+   ST_SPACE,
+};
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static int Counts[6];
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// Classify
+//
+static int Classify(int c)
+{
+   switch(c)
+   {
+   case ' ': case '\t': case '\n':
+      return ST_SPACE;
+
+   case '+': case '-': case '*': case '/': case '%':
+   case '&': case '|': case '^': case '=': case '(':
+   case ')': case ';':
+      return ST_OPER;
+
+   case '#':
+      return ST_COMMENT;
+
+   default:
+      if(c >= '0' && c <= '9') return ST_NUMBER;
+      return ST_NAME;
+   }
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// BenchState
+//
+void BenchState(void) __attribute__((__script__(enter)))
+{
+   // File scope initializers are not emitted for ACS targets.
+   char const *source =
+      "alpha = 12 + beta*3 # note\n"
+      "gamma=(alpha-7)/2; delta = gamma % 5 # end\n"
+      "x1 = 0xFF & y2 | z3 ^ 42;\n";
+
+   int pass, i, c, state, value = 0, hash = 0;
+
+   for(pass = 0; pass < 10; ++pass)
+   {
+      state = ST_START;
+
+      for(i = 0; (c = source[i]); ++i)
+      {
+         switch(state)
+         {
+         case ST_COMMENT:
+            if(c == '\n') state = ST_START;
+            continue;
+
+         case ST_NUMBER:
+            if(c >= '0' && c <= '9')
+            {
+               value = value * 10 + (c - '0');
+               continue;
+            }
+            hash += value;
+            break;
+
+         case ST_NAME:
+            if(Classify(c) == ST_NAME || Classify(c) == ST_NUMBER)
+            {
+               hash = hash * 31 + c;
+               continue;
+            }
+            break;
+
+         case ST_START:
+         case ST_OPER:
+         case ST_SPACE:
+            break;
+         }
+
+         state = Classify(c);
+         ++Counts[state];
+
+         switch(state)
+         {
+         case ST_NUMBER: value = c - '0'; break;
+         case ST_NAME:   hash = hash * 31 + c; break;
+         case ST_OPER:   hash ^= c << (pass & 7); break;
+         default: break;
+         }
+      }
+   }
+
+   printf("state %i %i %i %i %i %i\n", hash, Counts[ST_NUMBER],
+      Counts[ST_NAME], Counts[ST_OPER], Counts[ST_COMMENT], Counts[ST_SPACE]);
+}
+
+// EOF
@@ -0,0 +1,119 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Benchmark: structure copies.
+//
+//-----------------------------------------------------------------------------
+
+#include <stdio.h>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+typedef struct Vec3
+{
+   int x, y, z;
+} Vec3;
+
+typedef struct Body
+{
+   Vec3 pos;
+   Vec3 vel;
+   int  mass;
+   int  tag[4];
+} Body;
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static Body Bodies[8];
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// Step
+//
+static Body Step(Body b)
+{
+   b.pos.x += b.vel.x;
+   b.pos.y += b.vel.y;
+   b.pos.z += b.vel.z;
+   b.vel.z -= b.mass;
+   b.tag[b.mass & 3] += 1;
+
+   return b;
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// BenchStruct
+//
+void BenchStruct(void) __attribute__((__script__(enter)))
+{
+   Body tmp;
+   int  i, j, n, sum = 0;
+
+   for(i = 0; i < 8; ++i)
+   {
+      Bodies[i].pos.x = i;
+      Bodies[i].pos.y = i * 2;
+      Bodies[i].pos.z = 0;
+      Bodies[i].vel.x = 1;
+      Bodies[i].vel.y = -1;
+      Bodies[i].vel.z = 10 + i;
+      Bodies[i].mass  = i + 1;
+
+      for(j = 0; j < 4; ++j)
+         Bodies[i].tag[j] = 0;
+   }
+
+   for(n = 0; n < 20; ++n)
+   {
+      for(i = 0; i < 8; ++i)
+         Bodies[i] = Step(Bodies[i]);
+
+      // Rotate the array through a temporary.
+      tmp = Bodies[0];
+      for(i = 0; i < 7; ++i)
+         Bodies[i] = Bodies[i + 1];
+      Bodies[7] = tmp;
+   }
+
+   for(i = 0; i < 8; ++i)
+   {
+      Vec3 p = Bodies[i].pos;
+
+      sum += p.x * 3 + p.y * 5 + p.z + Bodies[i].tag[i & 3];
+   }
+
+   printf("struct %i %i %i\n", sum, Bodies[0].pos.z, Bodies[7].vel.z);
+}
+
+// EOF
@@ -369,6 +369,21 @@ __function int _Print_x(int flags, int width, int prec, char fmt, unsigned x);
 // %lx
 __function int _Print_lx(int flags, int width, int prec, char fmt, unsigned long x);
 
+// fprintf with a literal format ending in a newline.
+__function int _Fprintf_ln(FILE *stream, __string s);
+
+// fprintf with a literal format.
+__function int _Fprintf_str(FILE *stream, __string s);
+
+// printf with a literal format ending in a newline.
+__function int _Printf_ln(__string s);
+
+// printf with a literal format.
+__function int _Printf_str(__string s);
+
+// sprintf with a literal format.
+__function int _Sprintf_str(char *s, __string str);
+
 #if defined(__LANG_DS__) || defined(__cplusplus)
 };
 #endif
@@ -107,6 +107,19 @@ typedef struct _IdivLL_t
    long long int rem;
 } lldiv_t;
 
+//
+// _Mallinfo_t
+//
+// Statistics for the heap used by malloc.
+//
+struct _Mallinfo_t
+{
+   unsigned int used; // Size requested by every allocated block.
+   unsigned int peak; // Most that used has been.
+   unsigned int free; // Size of the free blocks below the top of the heap.
+   unsigned int heap; // Size of the heap below the top, headers included.
+};
+
 //
 // _Udiv_t
 //
@@ -257,6 +270,8 @@ __function long _IrshL(long i, int v);
 __function int _Getptr(void const __far *p);
 __function void _Setptr(int v, void __far *p);
 
+__function struct _Mallinfo_t _Mallinfo(void);
+
 __function unsigned long _UlshL(unsigned long u, int v);
 
 __function unsigned long _Umul32(unsigned l, unsigned r);
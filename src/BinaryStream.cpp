@@ -0,0 +1,113 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// In-memory binary output.
+//
+//-----------------------------------------------------------------------------
+
+#include "BinaryStream.hpp"
+
+#include <algorithm>
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// BinaryBuffer::overflow
+//
+BinaryBuffer::int_type BinaryBuffer::overflow(int_type c)
+{
+   if(traits_type::eq_int_type(c, traits_type::eof()))
+      return traits_type::not_eof(c);
+
+   char ch = traits_type::to_char_type(c);
+   xsputn(&ch, 1);
+
+   return c;
+}
+
+//
+// BinaryBuffer::seekoff
+//
+BinaryBuffer::pos_type BinaryBuffer::seekoff(off_type off,
+   std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+   if(!(which & std::ios_base::out)) return pos_type(off_type(-1));
+
+   off_type base;
+
+   switch(dir)
+   {
+   case std::ios_base::beg: base = 0;           break;
+   case std::ios_base::cur: base = pos;         break;
+   case std::ios_base::end: base = data.size(); break;
+   default: return pos_type(off_type(-1));
+   }
+
+   if(base + off < 0 || base + off > static_cast<off_type>(data.size()))
+      return pos_type(off_type(-1));
+
+   pos = base + off;
+
+   return pos_type(pos);
+}
+
+//
+// BinaryBuffer::seekpos
+//
+BinaryBuffer::pos_type BinaryBuffer::seekpos(pos_type sp,
+   std::ios_base::openmode which)
+{
+   return seekoff(off_type(sp), std::ios_base::beg, which);
+}
+
+//
+// BinaryBuffer::xsputn
+//
+std::streamsize BinaryBuffer::xsputn(char const *s, std::streamsize n)
+{
+   std::size_t count = n;
+
+   if(pos == data.size())
+      data.append(s, count);
+   else
+   {
+      std::size_t over = std::min(count, data.size() - pos);
+
+      data.replace(pos, over, s, over);
+      data.append(s + over, count - over);
+   }
+
+   pos += count;
+
+   return n;
+}
+
+//
+// BinaryStream::writeTo
+//
+void BinaryStream::writeTo(std::ostream *stream) const
+{
+   stream->write(str().data(), str().size());
+}
+
+// EOF
+
@@ -0,0 +1,88 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// In-memory binary output.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef HPP_BinaryStream_
+#define HPP_BinaryStream_
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// BinaryBuffer
+//
+// Collects output in a string. Seeking back overwrites what was written.
+//
+class BinaryBuffer : public std::streambuf
+{
+public:
+   BinaryBuffer() : pos(0) {}
+
+   std::string const &str() const {return data;}
+
+   void reserve(std::size_t size) {data.reserve(size);}
+   void reset() {data.clear(); pos = 0;}
+
+protected:
+   virtual int_type overflow(int_type c);
+   virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                            std::ios_base::openmode which);
+   virtual pos_type seekpos(pos_type sp, std::ios_base::openmode which);
+   virtual std::streamsize xsputn(char const *s, std::streamsize n);
+
+private:
+   std::string data;
+   std::size_t pos;
+};
+
+//
+// BinaryStream
+//
+// Used so that the final output is written all at once.
+//
+class BinaryStream : public std::ostream
+{
+public:
+   BinaryStream() : std::ostream(NULL) {rdbuf(&buf);}
+
+   std::size_t size() const {return buf.str().size();}
+   std::string const &str() const {return buf.str();}
+
+   void reserve(std::size_t size) {buf.reserve(size);}
+
+   // Discards the contents, but keeps the storage.
+   void reset() {buf.reset(); clear();}
+
+   void writeTo(std::ostream *stream) const;
+
+private:
+   BinaryBuffer buf;
+};
+
+#endif//HPP_BinaryStream_
+
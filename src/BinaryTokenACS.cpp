@@ -23,6 +23,7 @@
 
 #include "BinaryTokenACS.hpp"
 
+#include "BinaryStream.hpp"
 #include "ObjectExpression.hpp"
 #include "ost_type.hpp"
 #include "SourceException.hpp"
@@ -33,6 +34,7 @@
 //
 
 int BinaryTokenACS::arg_counts[BCODE_NONE];
+char const *BinaryTokenACS::names[BCODE_NONE];
 
 
 //----------------------------------------------------------------------------|
@@ -58,21 +60,38 @@ void BinaryTokenACS::addLabel(std::string const &label)
    labels.push_back(label);
 }
 
+//
+// BinaryTokenACS::getName
+//
+char const *BinaryTokenACS::getName() const
+{
+   return names[code];
+}
+
+//
+// BinaryTokenACS::getPosition
+//
+SourcePosition const &BinaryTokenACS::getPosition() const
+{
+   return position;
+}
+
 //
 // BinaryTokenACS::init
 //
 void BinaryTokenACS::init()
 {
-   init(arg_counts);
+   init(arg_counts, names);
 }
 
 //
 // BinaryTokenACS::init
 //
-void BinaryTokenACS::init(int *argCounts)
+void BinaryTokenACS::init(int *argCounts, char const **argNames)
 {
    #define DO_INIT(NAME,ARGC)\
-   argCounts[BCODE_##NAME] = ARGC
+   argCounts[BCODE_##NAME] = ARGC; \
+   argNames[BCODE_##NAME] = #NAME
 
    DO_INIT(NOP, 0);
 
@@ -181,7 +200,7 @@ void BinaryTokenACS::init(int *argCounts)
    DO_INIT(WAIT_STAG,                    0);
    DO_INIT(WAIT_STAG_IMM,                1);
    DO_INIT(WAIT_TICS,                    0);
-   DO_INIT(WAIT_TICS_IMM,                2);
+   DO_INIT(WAIT_TICS_IMM,                1);
 
    // ACS Printing
    DO_INIT(PRINT_CHARACTER, 0);
@@ -240,17 +259,26 @@ void BinaryTokenACS::writeACS0(std::ostream *out) const
 void BinaryTokenACS::
 write_all(std::ostream *out, std::vector<BinaryTokenACS> const &instructions)
 {
+   BinaryStream buf;
+
    output_prep(instructions);
 
+   // The code is most of the output, and its size is now known.
+   buf.reserve(ObjectExpression::get_address_count());
+
    switch(Output)
    {
    case OUTPUT_ACS0:
-      output_ACS0(out, instructions);
+      output_ACS0(&buf, instructions);
       break;
 
    default:
       Error_p("unknown output type");
    }
+
+   output_stats(instructions, buf.str());
+
+   buf.writeTo(out);
 }
 
 // EOF
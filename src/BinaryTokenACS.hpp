@@ -176,6 +176,10 @@ public:
 
    size_t getArgCount() const;
 
+   char const *getName() const;
+
+   SourcePosition const &getPosition() const;
+
    label_iterator label_begin() const;
    label_iterator label_end() const;
 
@@ -186,7 +190,7 @@ public:
 
 
    static void init();
-   static void init(int *argCounts);
+   static void init(int *argCounts, char const **argNames);
 
    static void make_tokens(ObjectToken const &object, std::vector<BinaryTokenACS> *instructions);
    static void make_tokens(ObjectVector const &objects, std::vector<BinaryTokenACS> *instructions);
@@ -194,7 +198,11 @@ public:
    template<typename T>
    static void output_ACS0(std::ostream *out, std::vector<T> const &instructions);
    template<typename T>
+   static void output_annotate(std::ostream *out, std::vector<T> const &instructions);
+   template<typename T>
    static void output_prep(std::vector<T> const &instructions);
+   template<typename T>
+   static void output_stats(std::vector<T> const &instructions, std::string const &data);
 
    static void write_ACS0_8(std::ostream *out, bigsint i);
    static void write_ACS0_16(std::ostream *out, bigsint i);
@@ -219,6 +227,7 @@ private:
 
 
    static int arg_counts[BCODE_NONE];
+   static char const *names[BCODE_NONE];
 };
 
 #endif//HPP_BinaryTokenZDACS_
@@ -0,0 +1,233 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Bytecode cost annotation.
+//
+// Attributes the final instructions, after all optimization, back to the
+// functions and source lines they came from. Inlined code is counted against
+// its own source lines but the function it was inlined into.
+//
+//-----------------------------------------------------------------------------
+
+#include "../BinaryTokenACS.hpp"
+
+#include "../BinaryTokenPPACS.hpp"
+#include "../BinaryTokenZDACS.hpp"
+#include "../ObjectData.hpp"
+#include "../ObjectExpression.hpp"
+#include "../SourcePosition.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// AnnotateCost
+//
+struct AnnotateCost
+{
+   AnnotateCost() : bytes(0), instrs(0) {}
+
+   std::string name;
+   std::string text;
+   biguint bytes;
+   biguint instrs;
+};
+
+typedef std::map<std::string, AnnotateCost> AnnotateFuncTable;
+typedef std::map<std::pair<std::string, long>, AnnotateCost> AnnotateLineTable;
+typedef std::map<std::string, std::vector<std::string>> AnnotateTextTable;
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+// Function and script labels mapped to their names.
+static std::map<std::string, std::string> AnnotateNames;
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// AddFunction
+//
+static void AddFunction(std::ostream *, ObjectData::Function const &f)
+{
+   if(!f.label.empty()) AnnotateNames[f.label] = f.name;
+}
+
+//
+// AddScript
+//
+static void AddScript(std::ostream *, ObjectData::Script const &s)
+{
+   if(!s.label.empty()) AnnotateNames[s.label] = s.name;
+}
+
+//
+// CompareCost
+//
+// Orders by bytes, highest first, then by name.
+//
+static bool CompareCost(AnnotateCost const &l, AnnotateCost const &r)
+{
+   if(l.bytes != r.bytes) return l.bytes > r.bytes;
+
+   return l.name < r.name;
+}
+
+//
+// FindText
+//
+// Returns the text of a source line, without leading space, if the file can
+// still be read.
+//
+static std::string FindText(AnnotateTextTable *texts, std::string const &name,
+                            long line)
+{
+   AnnotateTextTable::iterator text = texts->find(name);
+
+   if(text == texts->end())
+   {
+      text = texts->insert(std::make_pair(name, std::vector<std::string>())).first;
+
+      std::ifstream in(name.c_str());
+      std::string buf;
+
+      while(std::getline(in, buf))
+         text->second.push_back(buf);
+   }
+
+   if(line < 1 || static_cast<std::size_t>(line) > text->second.size())
+      return std::string();
+
+   std::string const &buf = text->second[line - 1];
+   std::string::size_type start = buf.find_first_not_of(" \t");
+
+   return start == std::string::npos ? std::string() : buf.substr(start);
+}
+
+//
+// WriteCosts
+//
+static void WriteCosts(std::ostream *out, std::vector<AnnotateCost> *costs,
+                       biguint total)
+{
+   std::stable_sort(costs->begin(), costs->end(), CompareCost);
+
+   for(auto const &cost : *costs)
+   {
+      char percent[16];
+      std::sprintf(percent, "%5.1f%%", total ? cost.bytes * 100.0 / total : 0.0);
+
+      *out << percent << ' ' << cost.bytes << ' ' << cost.instrs << ' '
+           << cost.name;
+
+      if(!cost.text.empty()) *out << "  " << cost.text;
+
+      *out << '\n';
+   }
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// BinaryTokenACS::output_annotate
+//
+template<typename T> void BinaryTokenACS::output_annotate
+(std::ostream *out, std::vector<T> const &instructions)
+{
+   AnnotateFuncTable funcs;
+   AnnotateLineTable lines;
+   AnnotateTextTable texts;
+   AnnotateCost total;
+   std::string func = "-";
+
+   AnnotateNames.clear();
+   ObjectData::Function::Iterate(AddFunction, NULL);
+   ObjectData::Script::Iterate(AddScript, NULL);
+
+   // Sizes can depend on address, so replay output_prep's addressing.
+   ObjectExpression::set_address_count(8);
+
+   for(auto const &instr : instructions)
+   {
+      for(auto label = instr.label_begin(); label != instr.label_end(); ++label)
+      {
+         auto name = AnnotateNames.find(*label);
+         if(name != AnnotateNames.end()) func = name->second;
+      }
+
+      biguint size = instr.size();
+      ObjectExpression::add_address_count(size);
+
+      SourcePosition const &pos = instr.getPosition();
+
+      AnnotateCost &funcCost = funcs[func];
+      AnnotateCost &lineCost = lines[std::make_pair(pos.filename, pos.line)];
+
+      funcCost.bytes += size; ++funcCost.instrs;
+      lineCost.bytes += size; ++lineCost.instrs;
+      total.bytes    += size; ++total.instrs;
+   }
+
+   std::vector<AnnotateCost> costs;
+
+   *out << "# total " << total.bytes << " bytes " << total.instrs
+        << " instructions\n";
+
+   *out << "\n# %bytes bytes instructions function\n";
+   for(auto &cost : funcs)
+   {
+      cost.second.name = cost.first;
+      costs.push_back(cost.second);
+   }
+   WriteCosts(out, &costs, total.bytes);
+
+   costs.clear();
+
+   *out << "\n# %bytes bytes instructions line source\n";
+   for(auto &cost : lines)
+   {
+      cost.second.name = cost.first.first + ':' + std::to_string(cost.first.second);
+      cost.second.text = FindText(&texts, cost.first.first, cost.first.second);
+      costs.push_back(cost.second);
+   }
+   WriteCosts(out, &costs, total.bytes);
+}
+template void BinaryTokenACS::output_annotate<BinaryTokenACS  >
+(std::ostream *out, std::vector<BinaryTokenACS  > const &instructions);
+template void BinaryTokenACS::output_annotate<BinaryTokenPPACS>
+(std::ostream *out, std::vector<BinaryTokenPPACS> const &instructions);
+template void BinaryTokenACS::output_annotate<BinaryTokenZDACS>
+(std::ostream *out, std::vector<BinaryTokenZDACS> const &instructions);
+
+// EOF
+
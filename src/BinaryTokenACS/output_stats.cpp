@@ -0,0 +1,344 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Output statistics.
+//
+// Every line starts with its kind and is sorted by name within its kind, so
+// that the reports from two builds can be compared with diff.
+//
+//-----------------------------------------------------------------------------
+
+#include "../BinaryTokenACS.hpp"
+
+#include "../BinaryTokenPPACS.hpp"
+#include "../BinaryTokenZDACS.hpp"
+#include "../ObjectData.hpp"
+#include "../ObjectExpression.hpp"
+#include "../option.hpp"
+#include "../ost_type.hpp"
+
+#include <fstream>
+#include <iostream>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// StatsCount
+//
+struct StatsCount
+{
+   StatsCount() : bytes(0), count(0) {}
+
+   biguint bytes;
+   biguint count;
+};
+
+//
+// StatsFunction
+//
+struct StatsFunction
+{
+   StatsFunction() : argCount(0), varCount(0) {}
+
+   std::string kind;
+   bigsint argCount;
+   bigsint varCount;
+   StatsCount size;
+};
+
+typedef std::map<std::string, StatsCount> StatsCountTable;
+typedef std::map<std::string, StatsFunction> StatsFunctionTable;
+
+
+//----------------------------------------------------------------------------|
+// Global Variables                                                           |
+//
+
+extern bool option_fake_ACS0;
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static option::option_data<std::string> option_stats
+('\0', "stats", "output",
+ "Indicates a file to write opcode counts, chunk sizes, and function sizes "
+ "of the output to. Use - to dump to stdout.", NULL);
+
+static StatsFunctionTable StatsFunctions;
+
+// Function and script labels mapped to their names.
+static std::map<std::string, std::string> StatsNames;
+
+static StatsCount StatsStrings;
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// AddFunction
+//
+static void AddFunction(std::ostream *, ObjectData::Function const &f)
+{
+   if(f.externDef || f.label.empty()) return;
+
+   StatsFunction &func = StatsFunctions[f.name];
+   func.kind     = "function";
+   func.argCount = f.argCount;
+   func.varCount = f.varCount;
+
+   StatsNames[f.label] = f.name;
+}
+
+//
+// AddScript
+//
+static void AddScript(std::ostream *, ObjectData::Script const &s)
+{
+   if(s.externDef || s.label.empty()) return;
+
+   StatsFunction &func = StatsFunctions[s.name];
+   func.kind     = "script";
+   func.argCount = s.argCount;
+   func.varCount = s.varCount;
+
+   StatsNames[s.label] = s.name;
+}
+
+//
+// AddString
+//
+static void AddString(std::ostream *, ObjectData::String const &s)
+{
+   StatsStrings.bytes += s.string.size() + 1;
+   ++StatsStrings.count;
+}
+
+//
+// Read32
+//
+static biguint Read32(std::string const &data, std::size_t pos)
+{
+   if(pos + 4 > data.size()) return 0;
+
+   return
+      (static_cast<biguint>(static_cast<unsigned char>(data[pos + 0])) <<  0) |
+      (static_cast<biguint>(static_cast<unsigned char>(data[pos + 1])) <<  8) |
+      (static_cast<biguint>(static_cast<unsigned char>(data[pos + 2])) << 16) |
+      (static_cast<biguint>(static_cast<unsigned char>(data[pos + 3])) << 24);
+}
+
+//
+// ReadChunks
+//
+// Sizes the chunks between begin and end. Each chunk's size includes its own
+// header, so that the sizes add up to the output's.
+//
+static void ReadChunks(std::string const &data, std::size_t begin,
+                       std::size_t end, StatsCountTable *chunks)
+{
+   while(begin + 8 <= end)
+   {
+      std::size_t size = Read32(data, begin + 4) + 8;
+      if(begin + size > end) break;
+
+      StatsCount &chunk = (*chunks)[data.substr(begin, 4)];
+      chunk.bytes += size;
+      ++chunk.count;
+
+      begin += size;
+   }
+
+   if(begin < end)
+   {
+      StatsCount &chunk = (*chunks)["(other)"];
+      chunk.bytes += end - begin;
+      ++chunk.count;
+   }
+}
+
+//
+// ReadSections
+//
+// Finds the parts of the written output from its header.
+//
+static void ReadSections(std::string const &data, StatsCountTable *chunks)
+{
+   std::size_t codeEnd;
+
+   switch(Output)
+   {
+   case OUTPUT_ACS0:
+      codeEnd = Read32(data, 4);
+
+      (*chunks)["(directory)"].bytes = data.size() - codeEnd;
+      (*chunks)["(directory)"].count = 1;
+      break;
+
+   case OUTPUT_ACSE:
+   case OUTPUT_ACSe:
+      if(option_fake_ACS0)
+      {
+         // The real header is at the end, which the fake one points to.
+         std::size_t header = Read32(data, 4) - 8;
+         if(header < 8 || header > data.size()) return;
+
+         codeEnd = Read32(data, header);
+         ReadChunks(data, codeEnd, header, chunks);
+
+         (*chunks)["(header)"].bytes += data.size() - header;
+      }
+      else
+      {
+         codeEnd = Read32(data, 4);
+         ReadChunks(data, codeEnd, data.size(), chunks);
+      }
+      break;
+
+   default:
+      return;
+   }
+
+   if(codeEnd < 8 || codeEnd > data.size()) return;
+
+   (*chunks)["(code)"].bytes = codeEnd - 8;
+   (*chunks)["(code)"].count = 1;
+
+   (*chunks)["(header)"].bytes += 8;
+   (*chunks)["(header)"].count = 1;
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// BinaryTokenACS::output_stats
+//
+// Writes the statistics of the output in data, if requested.
+//
+template<typename T> void BinaryTokenACS::output_stats
+(std::vector<T> const &instructions, std::string const &data)
+{
+   if(option_stats.data.empty()) return;
+
+   StatsCountTable chunks, codes;
+   StatsCount code, helpers;
+   StatsFunction none;
+   StatsFunction *func = &none;
+
+   StatsFunctions.clear();
+   StatsNames.clear();
+   StatsStrings = StatsCount();
+
+   ObjectData::Function::Iterate(AddFunction, NULL);
+   ObjectData::Script::Iterate(AddScript, NULL);
+   ObjectData::String::Iterate(AddString, NULL);
+
+   ReadSections(data, &chunks);
+
+   // Sizes can depend on address, so replay output_prep's addressing.
+   ObjectExpression::set_address_count(8);
+
+   for(auto const &instr : instructions)
+   {
+      for(auto label = instr.label_begin(); label != instr.label_end(); ++label)
+      {
+         auto name = StatsNames.find(*label);
+         if(name != StatsNames.end()) func = &StatsFunctions[name->second];
+      }
+
+      biguint size = instr.size();
+      ObjectExpression::add_address_count(size);
+
+      char const *name = instr.getName();
+      StatsCount &count = codes[name ? name : "(unknown)"];
+
+      count.bytes      += size; ++count.count;
+      code.bytes       += size; ++code.count;
+      func->size.bytes += size; ++func->size.count;
+   }
+
+   std::ofstream ofs;
+   std::ostream *out = &std::cout;
+
+   if(option_stats.data != "-")
+   {
+      ofs.open(option_stats.data.c_str());
+      out = &ofs;
+   }
+
+   *out << "# total bytes\n";
+   *out << "total " << data.size() << '\n';
+
+   *out << "\n# code bytes instructions\n";
+   *out << "code " << code.bytes << ' ' << code.count << '\n';
+
+   *out << "\n# chunk name bytes count\n";
+   for(auto const &chunk : chunks)
+      *out << "chunk " << chunk.first << ' ' << chunk.second.bytes << ' '
+           << chunk.second.count << '\n';
+
+   *out << "\n# strings bytes count\n";
+   *out << "strings " << StatsStrings.bytes << ' ' << StatsStrings.count << '\n';
+
+   *out << "\n# opcode name bytes count\n";
+   for(auto const &count : codes)
+      *out << "opcode " << count.first << ' ' << count.second.bytes << ' '
+           << count.second.count << '\n';
+
+   *out << "\n# function|script name bytes instructions args vars\n";
+   for(auto const &f : StatsFunctions)
+   {
+      *out << f.second.kind << ' ' << f.first << ' ' << f.second.size.bytes
+           << ' ' << f.second.size.count << ' ' << f.second.argCount << ' '
+           << f.second.varCount << '\n';
+
+      // Runtime support, such as long arithmetic and far pointer access, is
+      // in functions with reserved names.
+      if(f.first.compare(0, 2, "__") == 0)
+      {
+         helpers.bytes += f.second.size.bytes;
+         helpers.count += f.second.size.count;
+      }
+   }
+
+   if(none.size.count)
+      *out << "function - " << none.size.bytes << ' ' << none.size.count
+           << " 0 0\n";
+
+   *out << "\n# helpers bytes instructions\n";
+   *out << "helpers " << helpers.bytes << ' ' << helpers.count << '\n';
+}
+template void BinaryTokenACS::output_stats<BinaryTokenACS  >
+(std::vector<BinaryTokenACS  > const &instructions, std::string const &data);
+template void BinaryTokenACS::output_stats<BinaryTokenPPACS>
+(std::vector<BinaryTokenPPACS> const &instructions, std::string const &data);
+template void BinaryTokenACS::output_stats<BinaryTokenZDACS>
+(std::vector<BinaryTokenZDACS> const &instructions, std::string const &data);
+
+// EOF
+
@@ -61,8 +61,9 @@ void BinaryTokenACS::write_ACS0_8(std::ostream *out, bigsint i)
 //
 void BinaryTokenACS::write_ACS0_16(std::ostream *out, bigsint i)
 {
-   out->put(char((i >> 0) & 0xFF));
-   out->put(char((i >> 8) & 0xFF));
+   char const buf[2] = {char((i >> 0) & 0xFF), char((i >> 8) & 0xFF)};
+
+   out->write(buf, sizeof(buf));
 }
 
 //
@@ -78,10 +79,13 @@ void BinaryTokenACS::write_ACS0_32(std::ostream *out, ObjectExpression const &ex
 //
 void BinaryTokenACS::write_ACS0_32(std::ostream *out, bigsint i)
 {
-   out->put(char((i >>  0) & 0xFF));
-   out->put(char((i >>  8) & 0xFF));
-   out->put(char((i >> 16) & 0xFF));
-   out->put(char((i >> 24) & 0xFF));
+   char const buf[4] =
+   {
+      char((i >>  0) & 0xFF), char((i >>  8) & 0xFF),
+      char((i >> 16) & 0xFF), char((i >> 24) & 0xFF),
+   };
+
+   out->write(buf, sizeof(buf));
 }
 
 //
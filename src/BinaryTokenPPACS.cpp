@@ -24,6 +24,7 @@
 #include "BinaryTokenPPACS.hpp"
 
 #include "ACSP.hpp"
+#include "BinaryStream.hpp"
 #include "ObjectExpression.hpp"
 #include "ost_type.hpp"
 #include "SourceException.hpp"
@@ -36,6 +37,7 @@
 //
 
 int BinaryTokenPPACS::arg_counts[BCODE_NONE];
+char const *BinaryTokenPPACS::names[BCODE_NONE];
 
 
 //----------------------------------------------------------------------------|
@@ -62,15 +64,32 @@ void BinaryTokenPPACS::addLabel(std::string const &label)
    labels.push_back(label);
 }
 
+//
+// BinaryTokenPPACS::getName
+//
+char const *BinaryTokenPPACS::getName() const
+{
+   return names[code];
+}
+
+//
+// BinaryTokenPPACS::getPosition
+//
+SourcePosition const &BinaryTokenPPACS::getPosition() const
+{
+   return position;
+}
+
 //
 // BinaryTokenPPACS::init
 //
 void BinaryTokenPPACS::init()
 {
-   BinaryTokenACS::init(arg_counts);
+   BinaryTokenACS::init(arg_counts, names);
 
    #define DO_INIT(NAME,ARGC) \
-   arg_counts[BCODE_##NAME] = ARGC
+   arg_counts[BCODE_##NAME] = ARGC; \
+   names[BCODE_##NAME] = #NAME
 
    // Operators
    DO_INIT(ADD_AUTO,   1);
@@ -218,21 +237,30 @@ void BinaryTokenPPACS::writeACSP(std::ostream *out) const
 void BinaryTokenPPACS::
 write_all(std::ostream *out, std::vector<BinaryTokenPPACS> const &instructions)
 {
+   BinaryStream buf;
+
    BinaryTokenACS::output_prep(instructions);
 
+   // The code is most of the output, and its size is now known.
+   buf.reserve(ObjectExpression::get_address_count());
+
    switch(Output)
    {
    case OUTPUT_ACS0:
-      BinaryTokenACS::output_ACS0(out, instructions);
+      BinaryTokenACS::output_ACS0(&buf, instructions);
       break;
 
    case OUTPUT_ACSP:
-      output_ACSP(out, instructions);
+      output_ACSP(&buf, instructions);
       break;
 
    default:
       Error_p("unknown output type");
    }
+
+   BinaryTokenACS::output_stats(instructions, buf.str());
+
+   buf.writeTo(out);
 }
 
 // EOF
@@ -131,6 +131,10 @@ public:
 
    size_t getArgCount() const;
 
+   char const *getName() const;
+
+   SourcePosition const &getPosition() const;
+
    label_iterator label_begin() const;
    label_iterator label_end() const;
 
@@ -166,6 +170,7 @@ private:
 
 
    static int arg_counts[BCODE_NONE];
+   static char const *names[BCODE_NONE];
 };
 
 #endif//HPP_BinaryTokenPPACS_
@@ -23,6 +23,7 @@
 
 #include "BinaryTokenZDACS.hpp"
 
+#include "BinaryStream.hpp"
 #include "ObjectExpression.hpp"
 #include "ost_type.hpp"
 #include "SourceException.hpp"
@@ -33,6 +34,94 @@
 //
 
 int BinaryTokenZDACS::arg_counts[BCODE_NONE];
+char const *BinaryTokenZDACS::names[BCODE_NONE];
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// GetArgSizeACSe
+//
+// Returns the size in bytes of an argument in the compressed format.
+//
+static size_t GetArgSizeACSe(BinaryTokenZDACS::BinaryCode code, size_t index)
+{
+   #define CASE_AREA(OP) \
+      case BinaryTokenZDACS::BCODE_##OP##_REG: \
+      case BinaryTokenZDACS::BCODE_##OP##_MAPREG: \
+      case BinaryTokenZDACS::BCODE_##OP##_WLDREG: \
+      case BinaryTokenZDACS::BCODE_##OP##_GBLREG: \
+      case BinaryTokenZDACS::BCODE_##OP##_MAPARR: \
+      case BinaryTokenZDACS::BCODE_##OP##_WLDARR: \
+      case BinaryTokenZDACS::BCODE_##OP##_GBLARR
+
+   switch(code)
+   {
+   CASE_AREA(ADD):
+   CASE_AREA(AND):
+   CASE_AREA(DEC):
+   CASE_AREA(DIV):
+   CASE_AREA(GET):
+   CASE_AREA(INC):
+   CASE_AREA(IOR):
+   CASE_AREA(LSH):
+   CASE_AREA(MOD):
+   CASE_AREA(MUL):
+   CASE_AREA(RSH):
+   CASE_AREA(SET):
+   CASE_AREA(SUB):
+   CASE_AREA(XOR):
+   case BinaryTokenZDACS::BCODE_GET_FUNCP:
+   case BinaryTokenZDACS::BCODE_GET_IMM_BYTE:
+   case BinaryTokenZDACS::BCODE_GET_IMM_2BYTES:
+   case BinaryTokenZDACS::BCODE_GET_IMM_3BYTES:
+   case BinaryTokenZDACS::BCODE_GET_IMM_4BYTES:
+   case BinaryTokenZDACS::BCODE_GET_IMM_5BYTES:
+   case BinaryTokenZDACS::BCODE_JMP_CAL_IMM:
+   case BinaryTokenZDACS::BCODE_JMP_CAL_NIL_IMM:
+   case BinaryTokenZDACS::BCODE_MISC_RANDOM_IMM_BYTE:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC1_IMM_BYTE:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC2_IMM_BYTE:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC3_IMM_BYTE:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC4_IMM_BYTE:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC5_IMM_BYTE:
+   case BinaryTokenZDACS::BCODE_WAIT_TICS_IMM_BYTE:
+      return 1;
+
+   // Only the special number is compressed.
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC1:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC2:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC3:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC4:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC5:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC1_IMM:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC2_IMM:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC3_IMM:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC4_IMM:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC5_IMM:
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC5_RETN1:
+      return index ? 4 : 1;
+
+   // Argument count, then function index.
+   case BinaryTokenZDACS::BCODE_NATIVE:
+      return index ? 2 : 1;
+
+   default:
+      return 4;
+   }
+
+   #undef CASE_AREA
+}
+
+//
+// GetCodeSizeACSe
+//
+static size_t GetCodeSizeACSe(BinaryTokenZDACS::BinaryCode code)
+{
+   return code < 240 ? 1 : 2;
+}
 
 
 //----------------------------------------------------------------------------|
@@ -59,15 +148,32 @@ void BinaryTokenZDACS::addLabel(std::string const &label)
    labels.push_back(label);
 }
 
+//
+// BinaryTokenZDACS::getName
+//
+char const *BinaryTokenZDACS::getName() const
+{
+   return names[code];
+}
+
+//
+// BinaryTokenZDACS::getPosition
+//
+SourcePosition const &BinaryTokenZDACS::getPosition() const
+{
+   return position;
+}
+
 //
 // BinaryTokenZDACS::init
 //
 void BinaryTokenZDACS::init()
 {
-   BinaryTokenACS::init(arg_counts);
+   BinaryTokenACS::init(arg_counts, names);
 
    #define DO_INIT(NAME,ARGC) \
-   arg_counts[BCODE_##NAME] = ARGC
+   arg_counts[BCODE_##NAME] = ARGC; \
+   names[BCODE_##NAME] = #NAME
 
    // Operators
    DO_INIT(ADD_GBLREG, 1);
@@ -150,6 +256,23 @@ void BinaryTokenZDACS::init()
    DO_INIT(STK_COPY, 0);
    DO_INIT(STK_SWAP, 0);
 
+   // Compressed pushes
+   DO_INIT(GET_IMM_BYTE,   1);
+   DO_INIT(GET_IMM_BYTES, -1);
+   DO_INIT(GET_IMM_2BYTES, 2);
+   DO_INIT(GET_IMM_3BYTES, 3);
+   DO_INIT(GET_IMM_4BYTES, 4);
+   DO_INIT(GET_IMM_5BYTES, 5);
+
+   // Compressed immediates
+   DO_INIT(SPECIAL_EXEC1_IMM_BYTE, 2);
+   DO_INIT(SPECIAL_EXEC2_IMM_BYTE, 3);
+   DO_INIT(SPECIAL_EXEC3_IMM_BYTE, 4);
+   DO_INIT(SPECIAL_EXEC4_IMM_BYTE, 5);
+   DO_INIT(SPECIAL_EXEC5_IMM_BYTE, 6);
+   DO_INIT(WAIT_TICS_IMM_BYTE,     1);
+   DO_INIT(MISC_RANDOM_IMM_BYTE,   2);
+
    // Trigonometry
    DO_INIT(TRIG_COS, 0);
    DO_INIT(TRIG_SIN, 0);
@@ -338,6 +461,8 @@ BinaryTokenZDACS::label_iterator BinaryTokenZDACS::label_end() const
 //
 size_t BinaryTokenZDACS::size() const
 {
+   if (Output == OUTPUT_ACSe) return sizeACSe();
+
    if (arg_counts[code] < 0) switch (code)
    {
    case BCODE_JMP_TAB:
@@ -350,11 +475,42 @@ size_t BinaryTokenZDACS::size() const
       return arg_counts[code]*4 + 4;
 }
 
+//
+// BinaryTokenZDACS::sizeACSe
+//
+// Called during output_prep, so the address count is this token's address.
+//
+size_t BinaryTokenZDACS::sizeACSe() const
+{
+   size_t size = GetCodeSizeACSe(code);
+
+   if (arg_counts[code] < 0) switch (code)
+   {
+   case BCODE_GET_IMM_BYTES:
+      return size + 1 + args.size();
+
+   case BCODE_JMP_TAB:
+      // The table is aligned to a word.
+      size += -(ObjectExpression::get_address_count() + size) & 3;
+      return size + args.size()*4 + 4;
+
+   default:
+      Error(position, "???");
+   }
+
+   for (int i = 0; i < arg_counts[code]; ++i)
+      size += GetArgSizeACSe(code, i);
+
+   return size;
+}
+
 //
 // BinaryTokenZDACS::writeACS0
 //
 void BinaryTokenZDACS::writeACS0(std::ostream * out) const
 {
+   if (Output == OUTPUT_ACSe) return writeACSe(out);
+
    if (arg_counts[code] < 0) switch (code)
    {
    case BCODE_JMP_TAB:
@@ -384,27 +540,99 @@ void BinaryTokenZDACS::writeACS0(std::ostream * out) const
    }
 }
 
+//
+// BinaryTokenZDACS::writeACSe
+//
+void BinaryTokenZDACS::writeACSe(std::ostream * out) const
+{
+   if (code < 240)
+      BinaryTokenACS::write_ACS0_8(out, code);
+   else
+   {
+      BinaryTokenACS::write_ACS0_8(out, 240 + ((code - 240) >> 8));
+      BinaryTokenACS::write_ACS0_8(out, code - 240);
+   }
+
+   if (arg_counts[code] < 0) switch (code)
+   {
+   case BCODE_GET_IMM_BYTES:
+      BinaryTokenACS::write_ACS0_8(out, args.size());
+      for (size_t i = 0; i < args.size(); ++i)
+         BinaryTokenACS::write_ACS0_8(out, args[i]->resolveBinary(0));
+      return;
+
+   case BCODE_JMP_TAB:
+      for (bigsint pad = -out->tellp() & 3; pad--;)
+         BinaryTokenACS::write_ACS0_8(out, 0);
+
+      BinaryTokenACS::write_ACS0_32(out, args.size() / 2);
+      for (size_t i = 0; i < args.size(); i += 2)
+      {
+         BinaryTokenACS::write_ACS0_32(out, *args[i+0]);
+         BinaryTokenACS::write_ACS0_32(out, *args[i+1]);
+      }
+      return;
+
+   default:
+      Error(position, "???");
+   }
+
+   for (int i = 0; i < arg_counts[code]; ++i)
+   {
+      biguint arg = (size_t)i < args.size() ? args[i]->resolveBinary(0) : 0;
+
+      switch (GetArgSizeACSe(code, i))
+      {
+      case 1:
+         if (arg > 0xFF)
+            Error(position, "ACSe argument does not fit in a byte: %u", (unsigned)arg);
+         BinaryTokenACS::write_ACS0_8(out, arg);
+         break;
+
+      case 2:
+         if (arg > 0xFFFF)
+            Error(position, "ACSe argument does not fit in a short: %u", (unsigned)arg);
+         BinaryTokenACS::write_ACS0_16(out, arg);
+         break;
+
+      default:
+         BinaryTokenACS::write_ACS0_32(out, arg);
+         break;
+      }
+   }
+}
+
 //
 // BinaryTokenZDACS::write_all
 //
 void BinaryTokenZDACS::
 write_all(std::ostream *out, std::vector<BinaryTokenZDACS> const &instructions)
 {
+   BinaryStream buf;
+
    BinaryTokenACS::output_prep(instructions);
 
+   // The code is most of the output, and its size is now known.
+   buf.reserve(ObjectExpression::get_address_count());
+
    switch(Output)
    {
    case OUTPUT_ACS0:
-      BinaryTokenACS::output_ACS0(out, instructions);
+      BinaryTokenACS::output_ACS0(&buf, instructions);
       break;
 
    case OUTPUT_ACSE:
-      output_ACSE(out, instructions);
+   case OUTPUT_ACSe:
+      output_ACSE(&buf, instructions);
       break;
 
    default:
       Error_p("unknown output type");
    }
+
+   BinaryTokenACS::output_stats(instructions, buf.str());
+
+   buf.writeTo(out);
 }
 
 // EOF
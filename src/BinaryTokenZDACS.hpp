@@ -47,6 +47,7 @@ struct Script;
 struct String;
 }
 
+class BinaryStream;
 class ObjectExpression;
 class ObjectToken;
 class ObjectVector;
@@ -114,7 +115,19 @@ public:
       // Abyss of Abandoned Codes
       BCODE_PRINT_SET_FONT                     = 165,
       BCODE_PRINT_SET_FONT_IMM                 = 166,
-      // Abyss of Unusable Codes
+      BCODE_GET_IMM_BYTE                       = 167, // ACSe
+      BCODE_SPECIAL_EXEC1_IMM_BYTE             = 168, // ACSe
+      BCODE_SPECIAL_EXEC2_IMM_BYTE             = 169, // ACSe
+      BCODE_SPECIAL_EXEC3_IMM_BYTE             = 170, // ACSe
+      BCODE_SPECIAL_EXEC4_IMM_BYTE             = 171, // ACSe
+      BCODE_SPECIAL_EXEC5_IMM_BYTE             = 172, // ACSe
+      BCODE_WAIT_TICS_IMM_BYTE                 = 173, // ACSe
+      BCODE_MISC_RANDOM_IMM_BYTE               = 174, // ACSe
+      BCODE_GET_IMM_BYTES                      = 175, // ACSe
+      BCODE_GET_IMM_2BYTES                     = 176, // ACSe
+      BCODE_GET_IMM_3BYTES                     = 177, // ACSe
+      BCODE_GET_IMM_4BYTES                     = 178, // ACSe
+      BCODE_GET_IMM_5BYTES                     = 179, // ACSe
       BCODE_MTAG_SET_SPECIAL                   = 180,
       BCODE_SET_GBLREG                         = 181,
       BCODE_GET_GBLREG                         = 182,
@@ -312,12 +325,17 @@ public:
 
    size_t getArgCount() const;
 
+   char const *getName() const;
+
+   SourcePosition const &getPosition() const;
+
    label_iterator label_begin() const;
    label_iterator label_end() const;
 
    size_t size() const;
 
    void writeACS0(std::ostream * const out) const;
+   void writeACSe(std::ostream * const out) const;
 
 
 
@@ -325,6 +343,7 @@ public:
 
    static void make_tokens(ObjectToken const & object, std::vector<BinaryTokenZDACS> *instructions);
    static void make_tokens(ObjectVector const & objects, std::vector<BinaryTokenZDACS> *instructions);
+   static void make_tokens_ACSe(std::vector<BinaryTokenZDACS> *instructions);
 
    template<typename T>
    static void output_ACSE(std::ostream *out, std::vector<T> const &instructions);
@@ -336,7 +355,7 @@ public:
    static void write_ACSE_array_ASTR(std::ostream *out, ObjectData::Array const &a);
    static void write_ACSE_array_ATAG(std::ostream *out, ObjectData::Array const &a);
    static void write_ACSE_array_MEXP(std::ostream *out, ObjectData::Array const &a);
-   static void write_ACSE_chunk(std::ostream *out, std::ostringstream *chunkout, char const *chunkname);
+   static void write_ACSE_chunk(std::ostream *out, BinaryStream *chunkout, char const *chunkname);
    static void write_ACSE_counter(std::ostream *out);
    static void write_ACSE_function_FUNC(std::ostream *out, ObjectData::Function const &f);
    static void write_ACSE_function_FNAM(std::ostream *out, ObjectData::Function const &f);
@@ -356,6 +375,8 @@ public:
    static void write_all(std::ostream *out, std::vector<BinaryTokenZDACS> const &instructions);
 
 private:
+   size_t sizeACSe() const;
+
    std::vector<CounterPointer<ObjectExpression> > args;
    BinaryCode code;
    std::vector<std::string> labels;
@@ -364,6 +385,7 @@ private:
 
 
    static int arg_counts[BCODE_NONE];
+   static char const *names[BCODE_NONE];
 };
 
 #endif//HPP_BinaryTokenZDACS_
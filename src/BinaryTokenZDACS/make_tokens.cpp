@@ -28,6 +28,7 @@
 #include "../ObjectVector.hpp"
 #include "../SourceException.hpp"
 #include "../SourceExpression.hpp"
+#include "../ost_type.hpp"
 
 #include "../BinaryTokenACS/make_tokens.hpp"
 
@@ -115,6 +116,53 @@ if (object->getArg(0)->resolveINT())   \
 else (void)0
 
 
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// GetCodeByte
+//
+// Returns the compressed form of an immediate instruction, if any.
+//
+static BinaryTokenZDACS::BinaryCode GetCodeByte(BinaryTokenZDACS::BinaryCode code)
+{
+   switch(code)
+   {
+   case BinaryTokenZDACS::BCODE_MISC_RANDOM_IMM:
+      return BinaryTokenZDACS::BCODE_MISC_RANDOM_IMM_BYTE;
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC1_IMM:
+      return BinaryTokenZDACS::BCODE_SPECIAL_EXEC1_IMM_BYTE;
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC2_IMM:
+      return BinaryTokenZDACS::BCODE_SPECIAL_EXEC2_IMM_BYTE;
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC3_IMM:
+      return BinaryTokenZDACS::BCODE_SPECIAL_EXEC3_IMM_BYTE;
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC4_IMM:
+      return BinaryTokenZDACS::BCODE_SPECIAL_EXEC4_IMM_BYTE;
+   case BinaryTokenZDACS::BCODE_SPECIAL_EXEC5_IMM:
+      return BinaryTokenZDACS::BCODE_SPECIAL_EXEC5_IMM_BYTE;
+   case BinaryTokenZDACS::BCODE_WAIT_TICS_IMM:
+      return BinaryTokenZDACS::BCODE_WAIT_TICS_IMM_BYTE;
+   default:
+      return BinaryTokenZDACS::BCODE_NONE;
+   }
+}
+
+//
+// IsArgsByte
+//
+static bool IsArgsByte(std::vector<ObjectExpression::Pointer> const &args)
+{
+   for(auto const &arg : args)
+   {
+      if(!arg->canResolve() || arg->resolveBinary(0) > 0xFF)
+         return false;
+   }
+
+   return true;
+}
+
+
 //----------------------------------------------------------------------------|
 // Global Functions                                                           |
 //
@@ -526,6 +574,72 @@ void BinaryTokenZDACS::make_tokens
       Error_P("unknown OCODE: %s", make_string(object->code));
    }
    }
+
+   if(Output == OUTPUT_ACSe) make_tokens_ACSe(instructions);
+}
+
+//
+// BinaryTokenZDACS::make_tokens_ACSe
+//
+// Replaces pushes of small constants and immediate instructions with small
+// operands with the compressed forms. Labels have no address yet, so anything
+// that resolves now has its final value.
+//
+void BinaryTokenZDACS::make_tokens_ACSe(std::vector<BinaryTokenZDACS> *instructions)
+{
+   static BinaryCode const codes[] =
+   {
+      BCODE_GET_IMM_BYTE,   BCODE_GET_IMM_2BYTES, BCODE_GET_IMM_3BYTES,
+      BCODE_GET_IMM_4BYTES, BCODE_GET_IMM_5BYTES,
+   };
+
+   std::vector<BinaryTokenZDACS> packed;
+   std::vector<ObjectExpression::Pointer> args;
+
+   packed.reserve(instructions->size());
+
+   typedef std::vector<BinaryTokenZDACS>::const_iterator Iterator;
+
+   for(Iterator itr = instructions->begin(), end = instructions->end(); itr != end;)
+   {
+      BinaryCode codeByte = GetCodeByte(itr->code);
+
+      if(codeByte != BCODE_NONE && IsArgsByte(itr->args))
+      {
+         packed.push_back(BinaryTokenZDACS(codeByte, itr->position, itr->labels, itr->args));
+         ++itr;
+         continue;
+      }
+
+      args.clear();
+
+      // Collect a run of byte pushes, breaking at any label after the first.
+      for(Iterator run = itr; run != end && args.size() != 255; ++run)
+      {
+         if(run->code != BCODE_GET_IMM || (run != itr && !run->labels.empty()))
+            break;
+
+         ObjectExpression::Pointer const &arg = run->args[0];
+
+         if(!arg->canResolve() || arg->resolveBinary(0) > 0xFF)
+            break;
+
+         args.push_back(arg);
+      }
+
+      if(args.empty())
+      {
+         packed.push_back(*itr++);
+         continue;
+      }
+
+      BinaryCode code = args.size() <= 5 ? codes[args.size() - 1] : BCODE_GET_IMM_BYTES;
+
+      packed.push_back(BinaryTokenZDACS(code, itr->position, itr->labels, args));
+      itr += args.size();
+   }
+
+   instructions->swap(packed);
 }
 
 // EOF
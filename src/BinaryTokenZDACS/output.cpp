@@ -23,10 +23,10 @@
 
 #include "../BinaryTokenZDACS.hpp"
 
+#include "../BinaryStream.hpp"
 #include "../ObjectData.hpp"
 #include "../ObjectExpression.hpp"
-
-#include <sstream>
+#include "../ost_type.hpp"
 
 
 //----------------------------------------------------------------------------|
@@ -49,7 +49,10 @@ output_ACSE(std::ostream *out, std::vector<T> const &instructions)
 {
    typename std::vector<T>::const_iterator iter;
 
-   std::ostringstream chunkout;
+   BinaryStream chunkout;
+
+   // The compressed format is marked by a lowercase e.
+   char const format = Output == OUTPUT_ACSe ? 'e' : 'E';
 
    // Header
    if (option_fake_ACS0)
@@ -59,7 +62,7 @@ output_ACSE(std::ostream *out, std::vector<T> const &instructions)
    }
    else
    {
-      *out << 'A' << 'C' << 'S' << 'E';
+      *out << 'A' << 'C' << 'S' << format;
       BinaryTokenACS::write_ACS0_32(out, ObjectExpression::get_address_count());
    }
 
@@ -147,7 +150,7 @@ output_ACSE(std::ostream *out, std::vector<T> const &instructions)
    if (option_fake_ACS0)
    {
       BinaryTokenACS::write_ACS0_32(out, ObjectExpression::get_address_count());
-      *out << 'A' << 'C' << 'S' << 'E';
+      *out << 'A' << 'C' << 'S' << format;
 
       bigsint index = out->tellp(); out->seekp(4);
       BinaryTokenACS::write_ACS0_32(out, index);
@@ -23,6 +23,7 @@
 
 #include "../BinaryTokenZDACS.hpp"
 
+#include "../BinaryStream.hpp"
 #include "../ObjectData.hpp"
 #include "../ObjectExpression.hpp"
 #include "../option.hpp"
@@ -244,19 +245,17 @@ void BinaryTokenZDACS::write_ACSE_array_MEXP(std::ostream *, ObjectData::Array c
 // BinaryTokenZDACS::write_ACSE_chunk
 //
 void BinaryTokenZDACS::
-write_ACSE_chunk(std::ostream *out, std::ostringstream *chunkout,
+write_ACSE_chunk(std::ostream *out, BinaryStream *chunkout,
                  char const *chunkname)
 {
-   std::string chunk(chunkout->str());
-
-   if (chunk.size())
+   if (chunkout->size())
    {
       *out << chunkname;
-      BinaryTokenACS::write_ACS0_32(out, chunk.size());
-      *out << chunk;
+      BinaryTokenACS::write_ACS0_32(out, chunkout->size());
+      chunkout->writeTo(out);
    }
 
-   chunkout->str("");
+   chunkout->reset();
 }
 
 //
@@ -26,6 +26,8 @@
 #include "SourceExpression.hpp" // SourceExpression::ParseNumber
 
 #include <cmath>
+#include <cstring>
+#include <iterator>
 
 
 //----------------------------------------------------------------------------|
@@ -35,11 +37,11 @@
 //
 // LoadInt
 //
-static biguint LoadInt(std::istream &load)
+static biguint LoadInt(ObjectLoad &load)
 {
    biguint i = 0;
 
-   for(int c; (c = load.get()) && load;)
+   for(int c; (c = load.get()) > 0;)
       i = i * 16 + SourceExpression::ParseNumber(c);
 
    return i;
@@ -48,11 +50,11 @@ static biguint LoadInt(std::istream &load)
 //
 // LoadRealFrac
 //
-static bigreal LoadRealFrac(std::istream &load)
+static bigreal LoadRealFrac(ObjectLoad &load)
 {
    int c = load.get();
 
-   if(c == '\0') return 0;
+   if(c <= 0) return 0;
 
    return (SourceExpression::ParseNumber(c) + LoadRealFrac(load)) / 16;
 }
@@ -60,45 +62,77 @@ static bigreal LoadRealFrac(std::istream &load)
 //
 // LoadRealInt
 //
-static bigreal LoadRealInt(std::istream &load)
+static bigreal LoadRealInt(ObjectLoad &load)
 {
    bigreal i = 0;
 
-   for(int c; (c = load.get()) != '.' && load;)
+   for(int c; (c = load.get()) != '.' && c != EOF;)
       i = i * 16 + SourceExpression::ParseNumber(c);
 
    return i;
 }
 
+//
+// LoadVarint
+//
+// Reads an unsigned LEB128 number.
+//
+static biguint LoadVarint(ObjectLoad &load)
+{
+   biguint i = 0;
+
+   for(unsigned shift = 0;; shift += 7)
+   {
+      int c = load.get();
+      if(c == EOF) return 0;
+
+      if(shift < 64) i |= static_cast<biguint>(c & 0x7F) << shift;
+      if(!(c & 0x80)) return i;
+   }
+}
+
 //
 // SaveInt
 //
-static void SaveInt(std::ostream &save, biguint i)
+static void SaveInt(std::string &save, biguint i)
 {
    if(!i) return;
 
    SaveInt(save, i / 16);
-   save.put("0123456789ABCDEF"[i % 16]);
+   save += "0123456789ABCDEF"[i % 16];
 }
 
 //
 // SaveRealFrac
 //
-static void SaveRealFrac(std::ostream &save, bigreal f)
+static void SaveRealFrac(std::string &save, bigreal f)
 {
    for(; f; f = std::fmod(f, 1) * 16)
-      save.put("0123456789ABCDEF"[static_cast<unsigned>(std::floor(f))]);
+      save += "0123456789ABCDEF"[static_cast<unsigned>(std::floor(f))];
 }
 
 //
 // SaveRealInt
 //
-static void SaveRealInt(std::ostream &save, bigreal i)
+static void SaveRealInt(std::string &save, bigreal i)
 {
    if(!i) return;
 
    SaveRealInt(save, std::floor(i / 16));
-   save.put("0123456789ABCDEF"[static_cast<unsigned>(std::floor(std::fmod(i, 16)))]);
+   save += "0123456789ABCDEF"[static_cast<unsigned>(std::floor(std::fmod(i, 16)))];
+}
+
+//
+// SaveVarint
+//
+// Writes an unsigned LEB128 number.
+//
+static void SaveVarint(std::string &save, biguint i)
+{
+   for(; i > 0x7F; i >>= 7)
+      save += static_cast<char>((i & 0x7F) | 0x80);
+
+   save += static_cast<char>(i);
 }
 
 
@@ -106,16 +140,39 @@ static void SaveRealInt(std::ostream &save, bigreal i)
 // Global Functions                                                           |
 //
 
+//
+// ObjectLoad::ObjectLoad
+//
+ObjectLoad::ObjectLoad(std::istream &load) :
+   buffer(std::istreambuf_iterator<char>(load), std::istreambuf_iterator<char>()),
+   pos(0), version(OV_TEXT2), binary(false), fail(false)
+{
+}
+
+//
+// ObjectLoad::checkSize
+//
+bool ObjectLoad::checkSize(biguint size)
+{
+   if(size <= buffer.size() - pos)
+      return true;
+
+   fail = true;
+   return false;
+}
+
 //
 // ObjectLoad::loadPrimBool
 //
 bool ObjectLoad::loadPrimBool()
 {
-   if(!load) return false;
+   if(fail) return false;
 
-   int c = load.get();
+   int c = get();
+
+   if(binary) return c > 0;
 
-   while(load && load.get()) {}
+   while(get() > 0) {}
 
    return c != '0';
 }
@@ -125,9 +182,9 @@ bool ObjectLoad::loadPrimBool()
 //
 char ObjectLoad::loadPrimChar()
 {
-   if(!load) return '\0';
+   if(fail) return '\0';
 
-   return static_cast<char>(load.get());
+   return static_cast<char>(get());
 }
 
 //
@@ -135,14 +192,26 @@ char ObjectLoad::loadPrimChar()
 //
 bigreal ObjectLoad::loadPrimReal()
 {
-   if(!load) return 0.0;
+   if(fail) return 0.0;
 
-   char sign = load.get();
+   if(binary)
+   {
+      // IEEE double, little-endian.
+      biguint bits = 0;
+      for(int i = 0; i != 8; ++i)
+         bits |= static_cast<biguint>(get() & 0xFF) << (i * 8);
 
-   bigreal data = LoadRealInt(load);
-   data += LoadRealFrac(load);
+      double d;
+      std::memcpy(&d, &bits, sizeof(d));
+      return d;
+   }
 
-   return sign == '-' ? -data : data;
+   char sign = get();
+
+   bigreal d = LoadRealInt(*this);
+   d += LoadRealFrac(*this);
+
+   return sign == '-' ? -d : d;
 }
 
 //
@@ -150,12 +219,19 @@ bigreal ObjectLoad::loadPrimReal()
 //
 bigsint ObjectLoad::loadPrimSInt()
 {
-   if(!load) return 0;
+   if(fail) return 0;
 
-   if(load.get() == '-')
-      return -static_cast<bigsint>(LoadInt(load));
+   if(binary)
+   {
+      // Zig-zag encoded.
+      biguint i = LoadVarint(*this);
+      return static_cast<bigsint>(i >> 1) ^ -static_cast<bigsint>(i & 1);
+   }
+
+   if(get() == '-')
+      return -static_cast<bigsint>(LoadInt(*this));
    else
-      return static_cast<bigsint>(LoadInt(load));
+      return static_cast<bigsint>(LoadInt(*this));
 }
 
 //
@@ -163,9 +239,71 @@ bigsint ObjectLoad::loadPrimSInt()
 //
 biguint ObjectLoad::loadPrimUInt()
 {
-   if(!load) return 0;
+   if(fail) return 0;
+
+   return binary ? LoadVarint(*this) : LoadInt(*this);
+}
 
-   return LoadInt(load);
+//
+// ObjectLoad::loadString
+//
+ObjectLoad &ObjectLoad::loadString(std::string &str)
+{
+   if(!binary)
+   {
+      std::string::size_type size;
+
+      *this >> size;
+      if(!checkSize(size))
+      {
+         str.clear();
+         return *this;
+      }
+
+      str.resize(size);
+      loadRange(str.begin(), str.end());
+      loadNull();
+
+      return *this;
+   }
+
+   // Zero introduces a new string, anything else refers to an earlier one.
+   if(biguint index = LoadVarint(*this))
+   {
+      if(index <= strings.size())
+         str = strings[index - 1];
+      else
+      {
+         str.clear();
+         fail = true;
+      }
+
+      return *this;
+   }
+
+   biguint size = LoadVarint(*this);
+
+   if(size > buffer.size() - pos)
+   {
+      str.clear();
+      fail = true;
+      return *this;
+   }
+
+   str.assign(buffer, pos, size);
+   pos += size;
+
+   strings.push_back(str);
+
+   return *this;
+}
+
+//
+// ObjectSave::~ObjectSave
+//
+ObjectSave::~ObjectSave()
+{
+   save.write(buffer.data(), buffer.size());
 }
 
 //
@@ -173,10 +311,14 @@ biguint ObjectLoad::loadPrimUInt()
 //
 void ObjectSave::savePrimBool(bool data)
 {
-   if(!save) return;
-
-   save.put('0' + data);
-   save.put('\0');
+   if(binary)
+   {
+      buffer += static_cast<char>(data);
+      return;
+   }
+
+   buffer += data ? '1' : '0';
+   buffer += '\0';
 }
 
 //
@@ -184,9 +326,7 @@ void ObjectSave::savePrimBool(bool data)
 //
 void ObjectSave::savePrimChar(char data)
 {
-   if(!save) return;
-
-   save.put(data);
+   buffer += data;
 }
 
 //
@@ -194,15 +334,26 @@ void ObjectSave::savePrimChar(char data)
 //
 void ObjectSave::savePrimReal(bigreal data)
 {
-   if(!save) return;
+   if(binary)
+   {
+      // IEEE double, little-endian.
+      double d = static_cast<double>(data);
+      biguint bits;
+      std::memcpy(&bits, &d, sizeof(d));
 
-   if(data < 0) {data = -data; save.put('-');} else save.put('+');
+      for(int i = 0; i != 8; ++i)
+         buffer += static_cast<char>(bits >> (i * 8));
 
-   SaveRealInt(save, std::floor(data));
-   save.put('.');
-   SaveRealFrac(save, std::fmod(data, 1) * 16);
+      return;
+   }
 
-   save.put('\0');
+   if(data < 0) {data = -data; buffer += '-';} else buffer += '+';
+
+   SaveRealInt(buffer, std::floor(data));
+   buffer += '.';
+   SaveRealFrac(buffer, std::fmod(data, 1) * 16);
+
+   buffer += '\0';
 }
 
 //
@@ -210,13 +361,19 @@ void ObjectSave::savePrimReal(bigreal data)
 //
 void ObjectSave::savePrimSInt(bigsint data)
 {
-   if(!save) return;
+   if(binary)
+   {
+      // Zig-zag encoded.
+      SaveVarint(buffer, (static_cast<biguint>(data) << 1) ^
+         static_cast<biguint>(data >> 63));
+      return;
+   }
 
-   if(data < 0) {data = -data; save.put('-');} else save.put('+');
+   if(data < 0) {data = -data; buffer += '-';} else buffer += '+';
 
-   SaveInt(save, data);
+   SaveInt(buffer, data);
 
-   save.put('\0');
+   buffer += '\0';
 }
 
 //
@@ -224,12 +381,47 @@ void ObjectSave::savePrimSInt(bigsint data)
 //
 void ObjectSave::savePrimUInt(biguint data)
 {
-   if(!save) return;
+   if(binary)
+   {
+      SaveVarint(buffer, data);
+      return;
+   }
 
-   SaveInt(save, data);
+   SaveInt(buffer, data);
 
-   save.put('\0');
+   buffer += '\0';
 }
 
-// EOF
+//
+// ObjectSave::saveString
+//
+ObjectSave &ObjectSave::saveString(std::string const &str)
+{
+   if(!binary)
+   {
+      *this << str.size();
+      saveRange(str.begin(), str.end());
+      saveNull();
+
+      return *this;
+   }
 
+   // Each distinct string is written once, then referred to by index.
+   biguint &index = strings[str];
+
+   if(index)
+   {
+      SaveVarint(buffer, index);
+      return *this;
+   }
+
+   index = strings.size();
+
+   SaveVarint(buffer, 0);
+   SaveVarint(buffer, str.size());
+   buffer += str;
+
+   return *this;
+}
+
+// EOF
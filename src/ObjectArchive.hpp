@@ -26,11 +26,13 @@
 
 #include "bignum.hpp"
 
+#include <cstdio>
 #include <istream>
 #include <map>
 #include <ostream>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 
@@ -38,13 +40,29 @@
 // Types                                                                      |
 //
 
+//
+// ObjectVersion
+//
+// Stored in the last byte of the object header.
+//
+enum ObjectVersion
+{
+   OV_TEXT,   // Text, without function inline type and linkage.
+   OV_BINARY,
+   OV_TEXT2,
+};
+
 //
 // ObjectLoad
 //
+// Reads the whole stream up front. Starts out reading the text format, and
+// reads the binary format after setBinary. Record layout follows the version
+// set by setVersion, which is the current layout by default.
+//
 class ObjectLoad
 {
 public:
-   explicit ObjectLoad(std::istream &load_) : load(load_) {}
+   explicit ObjectLoad(std::istream &load);
 
    ObjectLoad &operator >> (bool &data)                   {return loadBool(data);}
    ObjectLoad &operator >> (char &data)                   {return loadChar(data);}
@@ -61,17 +79,41 @@ public:
    ObjectLoad &operator >> (unsigned int &data)           {return loadUInt(data);}
    ObjectLoad &operator >> (unsigned long int &data)      {return loadUInt(data);}
    ObjectLoad &operator >> (unsigned long long int &data) {return loadUInt(data);}
+   ObjectLoad &operator >> (std::string &data)            {return loadString(data);}
+
+   // Returns the next byte, or EOF.
+   int get()
+   {
+      if(pos != buffer.size())
+         return static_cast<unsigned char>(buffer[pos++]);
+
+      fail = true;
+      return EOF;
+   }
+
+   // Fails if size items cannot fit in the rest of the stream, as each item
+   // takes at least one byte.
+   bool checkSize(biguint size);
 
    template<typename T> ObjectLoad &loadBool(T &data);
    template<typename T> ObjectLoad &loadChar(T &data);
    template<typename T> ObjectLoad &loadEnum(T &data, T max) {return loadEnum(data, max, max);}
    template<typename T> ObjectLoad &loadEnum(T &data, T max, T bad);
-                        ObjectLoad &loadNull() {load.get(); return *this;}
+                        ObjectLoad &loadNull() {get(); return *this;}
    template<typename T> ObjectLoad &loadRange(T begin, T end);
    template<typename T> ObjectLoad &loadReal(T &data);
    template<typename T> ObjectLoad &loadSInt(T &data);
+                        ObjectLoad &loadString(std::string &data);
    template<typename T> ObjectLoad &loadUInt(T &data);
 
+   ObjectVersion getVersion() const {return version;}
+
+   void setBinary() {binary = true;}
+
+   void setVersion(ObjectVersion version_) {version = version_;}
+
+   explicit operator bool () const {return !fail;}
+
 private:
    bool    loadPrimBool();
    char    loadPrimChar();
@@ -79,16 +121,25 @@ private:
    bigsint loadPrimSInt();
    biguint loadPrimUInt();
 
-   std::istream &load;
+   std::vector<std::string> strings;
+   std::string buffer;
+   std::size_t pos;
+   ObjectVersion version;
+   bool binary;
+   bool fail;
 };
 
 //
 // ObjectSave
 //
+// Buffers everything and writes it out on destruction. Starts out writing the
+// text format, and writes the binary format after setBinary.
+//
 class ObjectSave
 {
 public:
-   explicit ObjectSave(std::ostream &save_) : save(save_) {}
+   explicit ObjectSave(std::ostream &save_) : save(save_), binary(false) {}
+   ~ObjectSave();
 
    ObjectSave &operator << (bool const &data)                   {return saveBool(data);}
    ObjectSave &operator << (char const &data)                   {return saveChar(data);}
@@ -105,16 +156,20 @@ public:
    ObjectSave &operator << (unsigned int const &data)           {return saveUInt(data);}
    ObjectSave &operator << (unsigned long int const &data)      {return saveUInt(data);}
    ObjectSave &operator << (unsigned long long int const &data) {return saveUInt(data);}
+   ObjectSave &operator << (std::string const &data)            {return saveString(data);}
 
    template<typename T> ObjectSave &saveBool(T const &data);
    template<typename T> ObjectSave &saveChar(T const &data);
    template<typename T> ObjectSave &saveEnum(T const &data);
-                        ObjectSave &saveNull() {save.put(0); return *this;}
+                        ObjectSave &saveNull() {buffer += '\0'; return *this;}
    template<typename T> ObjectSave &saveRange(T begin, T end);
    template<typename T> ObjectSave &saveReal(T const &data);
    template<typename T> ObjectSave &saveSInt(T const &data);
+                        ObjectSave &saveString(std::string const &data);
    template<typename T> ObjectSave &saveUInt(T const &data);
 
+   void setBinary() {binary = true;}
+
 private:
    void savePrimBool(bool    data);
    void savePrimChar(char    data);
@@ -122,7 +177,10 @@ private:
    void savePrimSInt(bigsint data);
    void savePrimUInt(biguint data);
 
+   std::unordered_map<std::string, biguint> strings;
+   std::string buffer;
    std::ostream &save;
+   bool binary;
 };
 
 
@@ -133,9 +191,6 @@ private:
 template<typename T, std::size_t N>
 ObjectSave &operator << (ObjectSave &arc, T const (&data)[N]);
 
-template<typename T>
-ObjectSave &operator << (ObjectSave &arc, std::basic_string<T> const &data);
-
 template<typename Tk, typename Tv>
 ObjectSave &operator << (ObjectSave &arc, std::map<Tk, Tv> const &data);
 
@@ -151,9 +206,6 @@ ObjectSave &operator << (ObjectSave &arc, std::vector<T> const &data);
 template<typename T, std::size_t N>
 ObjectLoad &operator >> (ObjectLoad &arc, T (&data)[N]);
 
-template<typename T>
-ObjectLoad &operator >> (ObjectLoad &arc, std::basic_string<T> &data);
-
 template<typename Tk, typename Tv>
 ObjectLoad &operator >> (ObjectLoad &arc, std::map<Tk, Tv> &data);
 
@@ -325,19 +377,6 @@ ObjectSave &operator << (ObjectSave &arc, T const (&data)[N])
    return arc;
 }
 
-//
-// operator ObjectSave << std::basic_string
-//
-template<typename T>
-ObjectSave &operator << (ObjectSave &arc, std::basic_string<T> const &data)
-{
-   arc << data.size();
-   arc.saveRange(data.begin(), data.end());
-   arc.saveNull();
-
-   return arc;
-}
-
 //
 // operator ObjectSave << std::map
 //
@@ -395,22 +434,6 @@ ObjectLoad &operator >> (ObjectLoad &arc, T (&data)[N])
    return arc;
 }
 
-//
-// operator ObjectLoad >> std::basic_string
-//
-template<typename T>
-ObjectLoad &operator >> (ObjectLoad &arc, std::basic_string<T> &data)
-{
-   typename std::basic_string<T>::size_type size;
-
-   arc >> size;
-   data.resize(size);
-   arc.loadRange(data.begin(), data.end());
-   arc.loadNull();
-
-   return arc;
-}
-
 //
 // operator ObjectLoad >> std::map
 //
@@ -421,6 +444,7 @@ ObjectLoad &operator >> (ObjectLoad &arc, std::map<Tk, Tv> &data)
    typename std::map<Tk, Tv>::size_type size;
 
    arc >> size;
+   if(!arc.checkSize(size)) return arc;
 
    while(size--)
    {
@@ -454,6 +478,7 @@ ObjectLoad &operator >> (ObjectLoad &arc, std::set<T> &data)
    typename std::set<T>::size_type size;
 
    arc >> size;
+   if(!arc.checkSize(size)) return arc;
 
    while(size--)
    {
@@ -475,6 +500,7 @@ ObjectLoad &operator >> (ObjectLoad &arc, std::vector<T> &data)
 
    sizeBase = data.size();
    arc >> sizeLoad;
+   if(!arc.checkSize(sizeLoad)) return arc;
    data.resize(sizeBase + sizeLoad);
    arc.loadRange(data.begin() + sizeBase, data.end());
 
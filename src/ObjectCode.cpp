@@ -72,6 +72,31 @@ ObjectCode ocode_get_code
    return codeIt->second;
 }
 
+//
+// ocode_get_helper
+//
+char const *ocode_get_helper(ObjectCode ocode)
+{
+   switch(ocode)
+   {
+   case OCODE_DIV_STK_U:
+   case OCODE_MOD_STK_U:
+      return "__Udiv";
+
+   case OCODE_GET_FARPTR:
+      return "__Getptr";
+
+   case OCODE_RSH_STK_U:
+      return "__Ursh";
+
+   case OCODE_SET_FARPTR:
+      return "__Setptr";
+
+   default:
+      return NULL;
+   }
+}
+
 //
 // ocode_is_delay
 //
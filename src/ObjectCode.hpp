@@ -68,6 +68,10 @@ struct ObjectCodeSet
 ObjectCode ocode_get_code
 (std::string const &data, SourcePosition const &position);
 
+// Returns the runtime function a back end may lower the passed ocode into a
+// call to, or NULL if there is none.
+char const *ocode_get_helper(ObjectCode ocode);
+
 // Returns true if the passed ocode delays further execution.
 bool ocode_is_delay(ObjectCode ocode);
 
@@ -28,6 +28,8 @@
 #include "Counter.hpp"
 #include "LinkSpec.hpp"
 
+#include <map>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -39,6 +41,7 @@
 class ObjectExpression;
 class ObjectLoad;
 class ObjectSave;
+class ObjectVector;
 class SourceContext;
 class VariableType;
 
@@ -62,6 +65,17 @@ enum InitType
 
 typedef std::vector<InitType> InitTypeVector;
 
+//
+// ObjectData::InlineType
+//
+enum InlineType
+{
+   IL_DEFAULT,
+   IL_HINT,
+   IL_ALWAYS,
+   IL_NEVER,
+};
+
 //
 // ObjectData::ScriptFlag
 //
@@ -178,6 +192,9 @@ struct ArrayVar
 
    static ObjectLoad &Load(ObjectLoad &arc);
 
+   // Removes internal map variables not named in names.
+   static void RetainMap(std::set<std::string> const &names);
+
    static ObjectSave &Save(ObjectSave &arc);
 };
 
@@ -223,16 +240,18 @@ struct Function
    bigsint retCount;
    bigsint varCount;
    CounterPointer<SourceContext> context;
+   InlineType inlineType;
    LinkageSpecifier linkage;
    bool externDef;
+   bool frameless; // Calls need not adjust the auto-stack pointer.
 
 
    static bool Add(std::string const &name, std::string const &label,
       bigsint argCount, bigsint retCount, SourceContext *context,
-      LinkageSpecifier linkage);
+      LinkageSpecifier linkage, InlineType inlineType = IL_DEFAULT);
    static bool Add(std::string const &name, std::string const &label,
       bigsint argCount, bigsint retCount, bigsint varCount,
-      LinkageSpecifier linkage);
+      LinkageSpecifier linkage, InlineType inlineType = IL_DEFAULT);
 
    static void GenerateSymbols();
 
@@ -240,7 +259,15 @@ struct Function
 
    static ObjectLoad &Load(ObjectLoad &arc);
 
+   // Removes defined functions not named in names.
+   static void Retain(std::set<std::string> const &names);
+
    static ObjectSave &Save(ObjectSave &arc);
+
+   static void SetFrameless(std::string const &name, bool frameless);
+
+   // Overrides the context-derived register count.
+   static void SetVarCount(std::string const &name, bigsint varCount);
 };
 
 //
@@ -264,9 +291,87 @@ struct Label
 
    static ObjectLoad &Load(ObjectLoad &arc);
 
+   // Removes labels not named in names.
+   static void Retain(std::set<std::string> const &names);
+
    static ObjectSave &Save(ObjectSave &arc);
 };
 
+//
+// ObjectData::Layout
+//
+// Orders statics, array variables, and strings for allocation.
+//
+struct Layout
+{
+   // Returns true if l should be allocated before r.
+   static bool Before(std::string const &nameL, bigsint sizeL,
+                      std::string const &nameR, bigsint sizeR);
+
+   // Records the order symbols are first used in and how often.
+   static void FindUse(ObjectVector const &objects);
+
+   // Returns the position of name's first use, or past every used symbol.
+   static bigsint FirstUse(std::string const &name);
+
+   // Returns how many instruction arguments refer to name.
+   static bigsint UseCount(std::string const &name);
+
+   // Writes every allocated static and array variable with summary stats.
+   static void WriteMap(std::ostream *out);
+};
+
+//
+// ObjectData::NumberSet
+//
+// Tracks which numbers are in use for first-fit allocation. Free numbers are
+// kept as merged ranges, so finding a gap only has to skip past the holes
+// left between reserved numbers.
+//
+class NumberSet
+{
+public:
+   NumberSet();
+
+   // Finds and reserves the lowest number at or above base that starts size
+   // free numbers.
+   bigsint alloc(bigsint base, bigsint size);
+
+   void clear();
+
+   void reserve(bigsint number, bigsint size);
+
+private:
+   typedef std::map<bigsint, bigsint> RangeMap;
+
+   // Maps the start of each free range to its end.
+   RangeMap ranges;
+};
+
+//
+// ObjectData::Profile
+//
+// Execution counts from a previous run, keyed on object name and line.
+//
+struct Profile
+{
+   // Finds the count of the first block at or after line in name.
+   static bool FindBlock(std::string const &name, bigsint line, biguint *count);
+
+   // Finds the number of times name was entered.
+   static bool FindFunction(std::string const &name, biguint *count);
+
+   // Returns true if name was never entered.
+   static bool IsCold(std::string const &name);
+
+   // Returns true if name was entered at least a hundredth as often as the
+   // most entered function or script.
+   static bool IsHot(std::string const &name);
+
+   // Returns true if a profile is in use.
+   static bool IsUsed();
+};
+
 //
 // ObjectData::Register
 //
@@ -345,6 +450,9 @@ struct Script
    static ObjectLoad &Load(ObjectLoad &arc);
 
    static ObjectSave &Save(ObjectSave &arc);
+
+   // Overrides the context-derived register count.
+   static void SetVarCount(std::string const &name, bigsint varCount);
 };
 
 //
@@ -375,6 +483,9 @@ struct Static
 
    static ObjectLoad &Load(ObjectLoad &arc);
 
+   // Removes defined statics not named in names.
+   static void Retain(std::set<std::string> const &names);
+
    static ObjectSave &Save(ObjectSave &arc);
 };
 
@@ -402,6 +513,9 @@ struct String
 
    static ObjectLoad &Load(ObjectLoad &arc);
 
+   // Removes strings with no name in names.
+   static void Retain(std::set<std::string> const &names);
+
    static ObjectSave &Save(ObjectSave &arc);
 };
 
@@ -445,6 +559,7 @@ ObjectSave &operator << (ObjectSave &arc, ObjectData::Auto       const &data);
 ObjectSave &operator << (ObjectSave &arc, ObjectData::Function   const &data);
 ObjectSave &operator << (ObjectSave &arc, ObjectData::Init       const &data);
 ObjectSave &operator << (ObjectSave &arc, ObjectData::InitType   const &data);
+ObjectSave &operator << (ObjectSave &arc, ObjectData::InlineType const &data);
 ObjectSave &operator << (ObjectSave &arc, ObjectData::Label      const &data);
 ObjectSave &operator << (ObjectSave &arc, ObjectData::Register   const &data);
 ObjectSave &operator << (ObjectSave &arc, ObjectData::Script     const &data);
@@ -458,6 +573,7 @@ ObjectLoad &operator >> (ObjectLoad &arc, ObjectData::Auto       &data);
 ObjectLoad &operator >> (ObjectLoad &arc, ObjectData::Function   &data);
 ObjectLoad &operator >> (ObjectLoad &arc, ObjectData::Init       &data);
 ObjectLoad &operator >> (ObjectLoad &arc, ObjectData::InitType   &data);
+ObjectLoad &operator >> (ObjectLoad &arc, ObjectData::InlineType &data);
 ObjectLoad &operator >> (ObjectLoad &arc, ObjectData::Label      &data);
 ObjectLoad &operator >> (ObjectLoad &arc, ObjectData::Register   &data);
 ObjectLoad &operator >> (ObjectLoad &arc, ObjectData::Script     &data);
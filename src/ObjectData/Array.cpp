@@ -52,7 +52,7 @@ static option::option_dptr<int> option_addr_array_handler
 
 static ArrayTable MapTable, WorldTable, GlobalTable;
 
-static std::set<bigsint> used;
+static ObjectData::NumberSet used;
 
 
 //----------------------------------------------------------------------------|
@@ -99,8 +99,7 @@ static void Add(ArrayTable &table, std::string const &name,
 //
 static void CountRegister(std::ostream *, Register const &r)
 {
-   for(bigsint i = r.size; i--;)
-      used.insert(r.number + i);
+   if(r.size) used.reserve(r.number, r.size);
 }
 
 //
@@ -129,27 +128,6 @@ static void GenerateInitMap(std::ostream *, ArrayVar const &v)
    GenerateInit(MapTable, v);
 }
 
-//
-// GenerateNumber
-//
-static void GenerateNumber(ArrayTable &table, Array &data)
-{
-   ArrayIter itr, end = table.end();
-   bigsint index = 0;
-
-begin:
-   for(itr = table.begin(); itr != end; ++itr)
-   {
-      if(used.count(index) || index == itr->second.number)
-      {
-         ++index;
-         goto begin;
-      }
-   }
-
-   data.number = index;
-}
-
 //
 // GenerateSize
 //
@@ -201,7 +179,10 @@ static void GenerateSymbols(ArrayTable &table)
    ObjectExpression::Pointer obj;
 
    for(itr = table.begin(); itr != end; ++itr)
-      if(itr->second.number == -1) GenerateNumber(table, itr->second);
+      if(itr->second.number >= 0) used.reserve(itr->second.number, 1);
+
+   for(itr = table.begin(); itr != end; ++itr)
+      if(itr->second.number == -1) itr->second.number = used.alloc(0, 1);
 
    for(itr = table.begin(); itr != end; ++itr)
    {
@@ -265,10 +246,10 @@ void Array::GenerateSymbols()
    used.clear(); Register::IterateMap(CountRegister, NULL);
    ObjectData::GenerateSymbols(MapTable);
 
-   used.clear(); used.insert(option_auto_array);
+   used.clear(); used.reserve(option_auto_array, 1);
    ObjectData::GenerateSymbols(WorldTable);
 
-   used.clear(); used.insert(option_addr_array);
+   used.clear(); used.reserve(option_addr_array, 1);
    ObjectData::GenerateSymbols(GlobalTable);
 
    // Set sizes.
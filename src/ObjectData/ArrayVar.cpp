@@ -27,6 +27,8 @@
 #include "../ObjectExpression.hpp"
 #include "../VariableType.hpp"
 
+#include <algorithm>
+
 
 //----------------------------------------------------------------------------|
 // Types                                                                      |
@@ -87,37 +89,11 @@ static void Add(ArrayVarTable &table, std::string const &array,
 }
 
 //
-// GenerateNumber
+// LayoutLess
 //
-static void GenerateNumber(ArrayVarTable &table, ArrayVar &data)
+static bool LayoutLess(ArrayVar const *l, ArrayVar const *r)
 {
-   ArrayVarIter itr, end = table.end();
-   bigsint index = 1, limit, itrI, itrL;
-
-begin:
-   for(itr = table.begin(); itr != end; ++itr)
-   {
-      if(itr->second.number < 0) continue;
-
-      // Only variables in the same array can collide.
-      if(itr->second.array != data.array) continue;
-
-      limit = index + data.size;
-
-      itrI = itr->second.number;
-      itrL = itrI + itr->second.size;
-      if(itrI == itrL) ++itrL;
-
-      // If either end of itr's range is in range, try again.
-      if((itrI >= index && limit > itrI) ||
-         (itrL >  index && limit > itrL))
-      {
-         index = itrL;
-         goto begin;
-      }
-   }
-
-   data.number = index;
+   return Layout::Before(l->name, l->size, r->name, r->size);
 }
 
 //
@@ -128,8 +104,22 @@ static void GenerateSymbols(ArrayVarTable &table)
    ArrayVarIter itr, end = table.end();
    ObjectExpression::Pointer obj;
 
+   // Only variables in the same array can collide.
+   std::map<std::string, NumberSet> numbers;
+   std::vector<ArrayVar *> order;
+
    for(itr = table.begin(); itr != end; ++itr)
-      if(itr->second.number == -1) GenerateNumber(table, itr->second);
+   {
+      if(itr->second.number >= 0)
+         numbers[itr->second.array].reserve(itr->second.number, itr->second.size);
+      else if(itr->second.number == -1)
+         order.push_back(&itr->second);
+   }
+
+   std::stable_sort(order.begin(), order.end(), LayoutLess);
+
+   for(ArrayVar *data : order)
+      data->number = numbers[data->array].alloc(1, data->size);
 
    for(itr = table.begin(); itr != end; ++itr)
    {
@@ -299,6 +289,22 @@ ObjectLoad &ArrayVar::Load(ObjectLoad &arc)
    return arc >> MapTable >> WorldTable >> GlobalTable;
 }
 
+//
+// ObjectData::ArrayVar::RetainMap
+//
+void ArrayVar::RetainMap(std::set<std::string> const &names)
+{
+   for(ArrayVarIter itr = MapTable.begin(); itr != MapTable.end();)
+   {
+      ArrayVar const &v = itr->second;
+
+      if(v.linkage == LINKAGE_INTERN && !v.externDef && !names.count(v.name))
+         MapTable.erase(itr++);
+      else
+         ++itr;
+   }
+}
+
 //
 // ObjectData::ArrayVar::Save
 //
@@ -55,21 +55,23 @@ namespace ObjectData
 //
 bool Function::Add(std::string const &name, std::string const &label,
    bigsint argCount, bigsint retCount, SourceContext *context,
-   LinkageSpecifier linkage)
+   LinkageSpecifier linkage, InlineType inlineType)
 {
    Function &data = Table[name];
 
    if(data.name != name)
    {
-      data.label     = label;
-      data.name      = name;
-      data.argCount  = argCount;
-      data.number    = -1;
-      data.retCount  = retCount;
-      data.varCount  = -1;
-      data.context   = context;
-      data.linkage   = linkage;
-      data.externDef = !context;
+      data.label      = label;
+      data.name       = name;
+      data.argCount   = argCount;
+      data.number     = -1;
+      data.retCount   = retCount;
+      data.varCount   = -1;
+      data.context    = context;
+      data.inlineType = inlineType;
+      data.linkage    = linkage;
+      data.externDef  = !context;
+      data.frameless  = false;
 
       ObjectExpression::add_symbol(name, ObjectExpression::ET_UNS);
 
@@ -81,6 +83,9 @@ bool Function::Add(std::string const &name, std::string const &label,
       data.externDef = false;
    }
 
+   if(inlineType != IL_DEFAULT)
+      data.inlineType = inlineType;
+
    return false;
 }
 
@@ -89,21 +94,23 @@ bool Function::Add(std::string const &name, std::string const &label,
 //
 bool Function::Add(std::string const &name, std::string const &label,
    bigsint argCount, bigsint retCount, bigsint varCount,
-   LinkageSpecifier linkage)
+   LinkageSpecifier linkage, InlineType inlineType)
 {
    Function &data = Table[name];
 
    if(data.name != name)
    {
-      data.label     = label;
-      data.name      = name;
-      data.argCount  = argCount;
-      data.number    = -1;
-      data.retCount  = retCount;
-      data.varCount  = varCount;
-      data.context   = NULL;
-      data.linkage   = linkage;
-      data.externDef = varCount == -1;
+      data.label      = label;
+      data.name       = name;
+      data.argCount   = argCount;
+      data.number     = -1;
+      data.retCount   = retCount;
+      data.varCount   = varCount;
+      data.context    = NULL;
+      data.inlineType = inlineType;
+      data.linkage    = linkage;
+      data.externDef  = varCount == -1;
+      data.frameless  = false;
 
       ObjectExpression::add_symbol(name, ObjectExpression::ET_UNS);
 
@@ -115,6 +122,9 @@ bool Function::Add(std::string const &name, std::string const &label,
       data.externDef = false;
    }
 
+   if(inlineType != IL_DEFAULT)
+      data.inlineType = inlineType;
+
    return false;
 }
 
@@ -153,7 +163,7 @@ void Function::Iterate(IterFunc iterFunc, std::ostream *out)
 
    for(iter = Table.begin(); iter != Table.end(); ++iter)
    {
-      if (iter->second.context)
+      if (iter->second.context && iter->second.varCount == -1)
          iter->second.varCount = iter->second.context->getLimit(STORE_REGISTER);
 
       iterFunc(out, iter->second);
@@ -168,6 +178,20 @@ ObjectLoad &Function::Load(ObjectLoad &arc)
    return arc >> Table;
 }
 
+//
+// ObjectData::Function::Retain
+//
+void Function::Retain(std::set<std::string> const &names)
+{
+   for(FunctionIter itr = Table.begin(); itr != Table.end();)
+   {
+      if(!itr->second.externDef && !names.count(itr->first))
+         Table.erase(itr++);
+      else
+         ++itr;
+   }
+}
+
 //
 // ObjectData::Function::Save
 //
@@ -176,6 +200,28 @@ ObjectSave &Function::Save(ObjectSave &arc)
    return arc << Table;
 }
 
+//
+// ObjectData::Function::SetFrameless
+//
+void Function::SetFrameless(std::string const &name, bool frameless)
+{
+   FunctionIter iter = Table.find(name);
+
+   if(iter != Table.end())
+      iter->second.frameless = frameless;
+}
+
+//
+// ObjectData::Function::SetVarCount
+//
+void Function::SetVarCount(std::string const &name, bigsint varCount)
+{
+   FunctionIter iter = Table.find(name);
+
+   if(iter != Table.end())
+      iter->second.varCount = varCount;
+}
+
 }
 
 //
@@ -183,8 +229,13 @@ ObjectSave &Function::Save(ObjectSave &arc)
 //
 void OA_Override(ObjectData::Function &out, ObjectData::Function const &in)
 {
+   ObjectData::InlineType inlineType = out.inlineType;
+
    if(out.externDef && !in.externDef)
       out = in;
+
+   if(out.inlineType == ObjectData::IL_DEFAULT)
+      out.inlineType = inlineType;
 }
 
 //
@@ -195,21 +246,53 @@ ObjectSave &operator << (ObjectSave &arc, ObjectData::Function const &data)
    auto varCount = data.context ? data.context->getLimit(STORE_REGISTER) : data.varCount;
 
    arc << data.label << data.name << data.argCount << data.number
-       << data.retCount << varCount << data.externDef;
+       << data.retCount << varCount << data.inlineType << data.linkage
+       << data.externDef;
 
    return arc;
 }
 
+//
+// operator ObjectSave << ObjectData::InlineType
+//
+ObjectSave &operator << (ObjectSave &arc, ObjectData::InlineType const &data)
+{
+   return arc.saveEnum(data);
+}
+
 //
 // operator ObjectLoad >> ObjectData::Function
 //
 ObjectLoad &operator >> (ObjectLoad &arc, ObjectData::Function &data)
 {
    arc >> data.label >> data.name >> data.argCount >> data.number
-       >> data.retCount >> data.varCount >> data.externDef;
+       >> data.retCount >> data.varCount;
+
+   // Version 0 text objects store neither the inline type nor the linkage.
+   // Such functions are taken to be external, so --gc-exports keeps them.
+   if(arc.getVersion() == OV_TEXT)
+   {
+      data.inlineType = ObjectData::IL_DEFAULT;
+      data.linkage    = LINKAGE_DS;
+   }
+   else
+      arc >> data.inlineType >> data.linkage;
+
+   arc >> data.externDef;
+
+   // Determined during optimization, so never archived.
+   data.frameless = false;
 
    return arc;
 }
 
+//
+// operator ObjectLoad >> ObjectData::InlineType
+//
+ObjectLoad &operator >> (ObjectLoad &arc, ObjectData::InlineType &data)
+{
+   return arc.loadEnum(data, ObjectData::IL_NEVER, ObjectData::IL_DEFAULT);
+}
+
 // EOF
 
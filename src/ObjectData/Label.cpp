@@ -102,6 +102,19 @@ ObjectLoad &Label::Load(ObjectLoad &arc)
    return arc >> Table;
 }
 
+//
+// ObjectData::Label::Retain
+//
+void Label::Retain(std::set<std::string> const &names)
+{
+   LabelTable table;
+
+   for(auto const &itr : Table)
+      if(names.count(itr.name)) table.push_back(itr);
+
+   Table.swap(table);
+}
+
 //
 // ObjectData::Label::Save
 //
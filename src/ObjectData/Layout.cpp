@@ -0,0 +1,270 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Object-level data layout.
+//
+//-----------------------------------------------------------------------------
+
+#include "../ObjectData.hpp"
+
+#include "../ObjectExpression.hpp"
+#include "../ObjectVector.hpp"
+#include "../option.hpp"
+#include "../SourceException.hpp"
+
+#include <algorithm>
+#include <ostream>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// LayoutEntry
+//
+struct LayoutEntry
+{
+   std::string area;
+   std::string name;
+   bigsint number;
+   bigsint size;
+};
+
+typedef std::vector<LayoutEntry> LayoutEntries;
+
+typedef std::map<std::string, bigsint> UseTable;
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static option::option_data<std::string> option_data_layout
+('\0', "data-layout", "optimization",
+ "Sets the order statics and array variables are allocated in. name keeps "
+ "declaration names together, size places larger objects first to fill "
+ "holes left by fixed addresses, and use places objects in the order the "
+ "code first refers to them. name by default.", NULL, "name");
+
+extern int option_static_offset;
+
+static LayoutEntries Entries;
+
+static UseTable UseCounts;
+static UseTable UseOrder;
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// AddEntry
+//
+static void AddEntry(std::string const &area, std::string const &name,
+   bigsint number, bigsint size)
+{
+   LayoutEntry entry;
+   entry.area   = area;
+   entry.name   = name;
+   entry.number = number;
+   entry.size   = size;
+
+   Entries.push_back(entry);
+}
+
+//
+// AddEntryGlobal
+//
+static void AddEntryGlobal(std::ostream *, ObjectData::ArrayVar const &v)
+{
+   AddEntry("global " + v.array, v.name, v.number, v.size);
+}
+
+//
+// AddEntryMap
+//
+static void AddEntryMap(std::ostream *, ObjectData::ArrayVar const &v)
+{
+   AddEntry("map " + v.array, v.name, v.number, v.size);
+}
+
+//
+// AddEntryStatic
+//
+static void AddEntryStatic(std::ostream *, ObjectData::Static const &s)
+{
+   AddEntry("static", s.name, s.number, s.size);
+}
+
+//
+// AddEntryWorld
+//
+static void AddEntryWorld(std::ostream *, ObjectData::ArrayVar const &v)
+{
+   AddEntry("world " + v.array, v.name, v.number, v.size);
+}
+
+//
+// EntryLess
+//
+static bool EntryLess(LayoutEntry const &l, LayoutEntry const &r)
+{
+   if(l.area != r.area) return l.area < r.area;
+   if(l.number != r.number) return l.number < r.number;
+   return l.name < r.name;
+}
+
+//
+// WriteArea
+//
+// Writes a summary of [begin, end), which all share an area.
+//
+static void WriteArea(std::ostream *out, LayoutEntries::const_iterator begin,
+   LayoutEntries::const_iterator end)
+{
+   bigsint base = begin->area == "static" ? option_static_offset : 1;
+   bigsint count = 0, words = 0, limit = base;
+
+   for(LayoutEntries::const_iterator itr = begin; itr != end; ++itr)
+   {
+      if(itr->number < 0) continue;
+
+      ++count;
+      words += itr->size;
+      limit = std::max(limit, itr->number + itr->size);
+   }
+
+   *out << "# " << begin->area << ": " << count << " objects, " << words
+        << " words, span " << (limit - base) << ", "
+        << (limit - base - words) << " unused\n";
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+namespace ObjectData
+{
+
+//
+// ObjectData::Layout::Before
+//
+bool Layout::Before(std::string const &nameL, bigsint sizeL,
+   std::string const &nameR, bigsint sizeR)
+{
+   if(option_data_layout.data == "size")
+   {
+      if(sizeL != sizeR) return sizeL > sizeR;
+   }
+   else if(option_data_layout.data == "use")
+   {
+      bigsint useL = FirstUse(nameL), useR = FirstUse(nameR);
+
+      if(useL != useR) return useL < useR;
+   }
+
+   return nameL < nameR;
+}
+
+//
+// ObjectData::Layout::FindUse
+//
+void Layout::FindUse(ObjectVector const &objects)
+{
+   UseCounts.clear();
+   UseOrder.clear();
+
+   if(option_data_layout.data != "name" && option_data_layout.data != "size" &&
+      option_data_layout.data != "use")
+      Error_p("unknown data-layout: %s", option_data_layout.data.c_str());
+
+   std::set<std::string> symbols;
+   bigsint order = 0;
+
+   for(ObjectVector::const_iterator itr = objects.begin(), end = objects.end();
+       itr != end; ++itr)
+   {
+      for(auto const &arg : itr->args)
+      {
+         symbols.clear();
+         arg->findSymbols(&symbols);
+
+         for(auto const &symbol : symbols)
+         {
+            if(!UseOrder.count(symbol)) UseOrder[symbol] = order++;
+            ++UseCounts[symbol];
+         }
+      }
+   }
+}
+
+//
+// ObjectData::Layout::FirstUse
+//
+bigsint Layout::FirstUse(std::string const &name)
+{
+   UseTable::const_iterator itr = UseOrder.find(name);
+
+   return itr == UseOrder.end() ? UseOrder.size() : itr->second;
+}
+
+//
+// ObjectData::Layout::UseCount
+//
+bigsint Layout::UseCount(std::string const &name)
+{
+   UseTable::const_iterator itr = UseCounts.find(name);
+
+   return itr == UseCounts.end() ? 0 : itr->second;
+}
+
+//
+// ObjectData::Layout::WriteMap
+//
+void Layout::WriteMap(std::ostream *out)
+{
+   Entries.clear();
+   Static::Iterate(AddEntryStatic, NULL);
+   ArrayVar::IterateMap(AddEntryMap, NULL);
+   ArrayVar::IterateWorld(AddEntryWorld, NULL);
+   ArrayVar::IterateGlobal(AddEntryGlobal, NULL);
+
+   std::sort(Entries.begin(), Entries.end(), EntryLess);
+
+   for(LayoutEntries::const_iterator itr = Entries.begin(), end = Entries.end(); itr != end;)
+   {
+      LayoutEntries::const_iterator areaEnd = itr;
+      while(areaEnd != end && areaEnd->area == itr->area) ++areaEnd;
+
+      WriteArea(out, itr, areaEnd);
+
+      for(; itr != areaEnd; ++itr)
+         *out << itr->number << ' ' << itr->size << ' ' << itr->name << '\n';
+   }
+
+   Entries.clear();
+}
+
+}
+
+// EOF
+
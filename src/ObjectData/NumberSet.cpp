@@ -0,0 +1,114 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Object-level number allocation.
+//
+//-----------------------------------------------------------------------------
+
+#include "../ObjectData.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+namespace ObjectData
+{
+
+//
+// ObjectData::NumberSet::NumberSet
+//
+NumberSet::NumberSet()
+{
+   clear();
+}
+
+//
+// ObjectData::NumberSet::alloc
+//
+bigsint NumberSet::alloc(bigsint base, bigsint size)
+{
+   // Empty objects still take a number, as they always have.
+   if(size < 1) size = 1;
+
+   RangeMap::iterator itr = ranges.upper_bound(base);
+   if(itr != ranges.begin()) --itr;
+
+   for(RangeMap::iterator end = ranges.end(); itr != end; ++itr)
+   {
+      bigsint number = std::max(itr->first, base);
+
+      if(number <= itr->second - size)
+      {
+         reserve(number, size);
+         return number;
+      }
+   }
+
+   // Only reachable by exhausting the whole number space.
+   return base;
+}
+
+//
+// ObjectData::NumberSet::clear
+//
+void NumberSet::clear()
+{
+   ranges.clear();
+   ranges[std::numeric_limits<bigsint>::min()] = std::numeric_limits<bigsint>::max();
+}
+
+//
+// ObjectData::NumberSet::reserve
+//
+void NumberSet::reserve(bigsint number, bigsint size)
+{
+   if(size < 1) size = 1;
+
+   bigsint limit = number + size;
+
+   // Start with the range containing number, if any.
+   RangeMap::iterator itr = ranges.upper_bound(number);
+   if(itr != ranges.begin() && std::prev(itr)->second > number) --itr;
+
+   while(itr != ranges.end() && itr->first < limit)
+   {
+      bigsint rangeBegin = itr->first, rangeEnd = itr->second;
+
+      itr = ranges.erase(itr);
+
+      if(rangeBegin < number)
+         ranges[rangeBegin] = number;
+
+      if(rangeEnd > limit)
+      {
+         ranges[limit] = rangeEnd;
+         break;
+      }
+   }
+}
+
+}
+
+// EOF
+
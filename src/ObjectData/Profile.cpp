@@ -0,0 +1,186 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Object-level execution profile.
+//
+// The profile is the output of instrdump: a count, kind, object name, and
+// source position per line. Blocks are looked up by name and line only, so
+// that a profile still applies after edits elsewhere in the file.
+//
+//-----------------------------------------------------------------------------
+
+#include "../ObjectData.hpp"
+
+#include "../option.hpp"
+#include "../SourceException.hpp"
+#include "../SourcePosition.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+typedef std::map<bigsint, biguint> LineTable;
+typedef std::map<std::string, LineTable> BlockTable;
+typedef std::map<std::string, biguint> FunctionTable;
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static option::option_data<std::string> option_profile_use
+('\0', "profile-use", "optimization",
+ "Indicates a file of execution counts, as written by instrdump, to guide "
+ "inlining, switch lowering, and function order.", NULL);
+
+static BlockTable Blocks;
+static FunctionTable Functions;
+static biguint FunctionMax;
+static bool Loaded;
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// Load
+//
+static void Load()
+{
+   if(Loaded) return;
+
+   Loaded = true;
+
+   if(option_profile_use.data.empty()) return;
+
+   std::ifstream in(option_profile_use.data.c_str());
+
+   if(!in)
+      Error_p("failed to open profile: %s", option_profile_use.data.c_str());
+
+   std::string line;
+
+   while(std::getline(in, line))
+   {
+      if(line.empty() || line[0] == '#') continue;
+
+      std::istringstream iss(line);
+      std::string kind, name, pos;
+      biguint count;
+
+      if(!(iss >> count >> kind >> name >> pos)) continue;
+
+      // The position is file:line:column, and the file may contain colons.
+      std::string::size_type colEnd = pos.rfind(':');
+      if(colEnd == std::string::npos || !colEnd) continue;
+
+      std::string::size_type lineEnd = pos.rfind(':', colEnd - 1);
+      if(lineEnd == std::string::npos) continue;
+
+      bigsint lineNum = std::atol(pos.substr(lineEnd + 1).c_str());
+
+      biguint &block = Blocks[name][lineNum];
+      if(block < count) block = count;
+
+      if(kind == "function" || kind == "script")
+      {
+         Functions[name] = count;
+
+         if(FunctionMax < count) FunctionMax = count;
+      }
+   }
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+namespace ObjectData
+{
+
+//
+// ObjectData::Profile::FindBlock
+//
+bool Profile::FindBlock(std::string const &name, bigsint line, biguint *count)
+{
+   Load();
+
+   BlockTable::const_iterator blocks = Blocks.find(name);
+   if(blocks == Blocks.end()) return false;
+
+   LineTable::const_iterator block = blocks->second.lower_bound(line);
+   if(block == blocks->second.end()) return false;
+
+   *count = block->second;
+   return true;
+}
+
+//
+// ObjectData::Profile::FindFunction
+//
+bool Profile::FindFunction(std::string const &name, biguint *count)
+{
+   Load();
+
+   FunctionTable::const_iterator function = Functions.find(name);
+   if(function == Functions.end()) return false;
+
+   *count = function->second;
+   return true;
+}
+
+//
+// ObjectData::Profile::IsCold
+//
+bool Profile::IsCold(std::string const &name)
+{
+   biguint count;
+
+   return FindFunction(name, &count) && !count;
+}
+
+//
+// ObjectData::Profile::IsHot
+//
+bool Profile::IsHot(std::string const &name)
+{
+   biguint count;
+
+   return FindFunction(name, &count) && count && count * 100 >= FunctionMax;
+}
+
+//
+// ObjectData::Profile::IsUsed
+//
+bool Profile::IsUsed()
+{
+   return !option_profile_use.data.empty();
+}
+
+}
+
+// EOF
+
@@ -37,18 +37,6 @@ typedef std::map<std::string, ObjectData::Register> RegisterTable;
 typedef RegisterTable::iterator RegisterIter;
 
 
-//----------------------------------------------------------------------------|
-// Static Prototypes                                                          |
-//
-
-namespace ObjectData
-{
-
-static void SetNumber(RegisterTable &table, ObjectData::Register &data);
-
-}
-
-
 //----------------------------------------------------------------------------|
 // Static Variables                                                           |
 //
@@ -115,9 +103,19 @@ static void GenerateSymbols(RegisterTable &table)
 {
    ObjectExpression::Pointer obj;
    RegisterIter iter;
+   NumberSet numbers;
+
+   // The world table also holds the stack-pointer.
+   if (&table == &WorldTable)
+      numbers.reserve(option_addr_stack, 1);
 
    for (iter = table.begin(); iter != table.end(); ++iter)
-      if (iter->second.number == -1) SetNumber(table, iter->second);
+      if (iter->second.number >= 0)
+         numbers.reserve(iter->second.number, iter->second.size);
+
+   for (iter = table.begin(); iter != table.end(); ++iter)
+      if (iter->second.number == -1)
+         iter->second.number = numbers.alloc(0, iter->second.size);
 
    for (iter = table.begin(); iter != table.end(); ++iter)
    {
@@ -136,48 +134,6 @@ static void Iterate(RegisterTable &table, Register::IterFunc iterFunc, std::ostr
       iterFunc(out, iter->second);
 }
 
-//
-// SetNumber
-//
-static void SetNumber(RegisterTable &table, Register &data)
-{
-   RegisterIter iter = table.begin();
-   bigsint index = 0, limit, iterI, iterL;
-
-   while (iter != table.end())
-   {
-      if (iter->second.number < 0) {++iter; continue;}
-
-      limit = index + data.size;
-
-      // If this is the world table and stack-pointer is in range, try again.
-      if (&table == &WorldTable &&
-          option_addr_stack >= index && limit > option_addr_stack)
-      {
-         index = option_addr_stack + 1;
-         iter = table.begin();
-         continue;
-      }
-
-      iterI = iter->second.number;
-      iterL = iterI + iter->second.size;
-      if (!iter->second.size) ++iterL;
-
-      // If either end of the iter's range is in range, try again.
-      if ((iterI >= index && limit > iterI) ||
-          (iterL >  index && limit > iterL))
-      {
-         index = iterL;
-         iter = table.begin();
-         continue;
-      }
-
-      ++iter;
-   }
-
-   data.number = index;
-}
-
 }
 
 
@@ -63,36 +63,6 @@ static ScriptTable Table;
 bool option_named_scripts = false;
 
 
-//----------------------------------------------------------------------------|
-// Static Functions                                                           |
-//
-
-namespace ObjectData
-{
-
-//
-// GetNumber
-//
-static bigsint GetNumber()
-{
-   ScriptIter iter;
-   bigsint number = option_script_start;
-
-   for(iter = Table.begin(); iter != Table.end(); ++iter)
-   {
-      if (iter->second.number == number)
-      {
-         ++number;
-         iter = Table.begin();
-      }
-   }
-
-   return number;
-}
-
-}
-
-
 //----------------------------------------------------------------------------|
 // Global Functions                                                           |
 //
@@ -187,6 +157,7 @@ void ObjectData::Script::GenerateSymbols()
 {
    ObjectExpression::Pointer obj;
    ScriptIter iter;
+   NumberSet numbers;
    bigsint number = 0;
 
    // If not set yet, generate varCount.
@@ -197,6 +168,12 @@ void ObjectData::Script::GenerateSymbols()
    }
 
    // Generate numbers.
+   for(iter = Table.begin(); iter != Table.end(); ++iter)
+   {
+      if(iter->second.number >= 0)
+         numbers.reserve(iter->second.number, 1);
+   }
+
    for(iter = Table.begin(); iter != Table.end(); ++iter)
    {
       if (iter->second.number >= 0 || iter->second.externDef) continue;
@@ -204,7 +181,7 @@ void ObjectData::Script::GenerateSymbols()
       if(iter->second.number == -2)
          iter->second.number = --number;
       else
-         iter->second.number = GetNumber();
+         iter->second.number = numbers.alloc(option_script_start, 1);
    }
 
    // Generate symbols.
@@ -229,7 +206,7 @@ void Script::Iterate(IterFunc iterFunc, std::ostream *out)
 
    for(iter = Table.begin(); iter != Table.end(); ++iter)
    {
-      if (iter->second.context)
+      if (iter->second.context && iter->second.varCount == -1)
          iter->second.varCount = iter->second.context->getLimit(STORE_REGISTER);
 
       iterFunc(out, iter->second);
@@ -252,6 +229,17 @@ ObjectSave &Script::Save(ObjectSave &arc)
    return arc << Table;
 }
 
+//
+// ObjectData::Script::SetVarCount
+//
+void Script::SetVarCount(std::string const &name, bigsint varCount)
+{
+   ScriptIter iter = Table.find(name);
+
+   if(iter != Table.end())
+      iter->second.varCount = varCount;
+}
+
 }
 
 //
@@ -29,6 +29,8 @@
 #include "../ost_type.hpp"
 #include "../VariableType.hpp"
 
+#include <algorithm>
+
 
 //----------------------------------------------------------------------------|
 // Types                                                                      |
@@ -62,42 +64,12 @@ int option_static_offset = 8192;
 // Static Functions                                                           |
 //
 
-namespace ObjectData
-{
-
 //
-// SetNumber
+// LayoutLess
 //
-void SetNumber(Static &data)
+static bool LayoutLess(ObjectData::Static const *l, ObjectData::Static const *r)
 {
-   StaticIter itr = Table.begin(), end = Table.end();
-   bigsint index = option_static_offset, limit, iterI, iterL;
-
-   while (itr != end)
-   {
-      if (itr->second.number < 0) {++itr; continue;}
-
-      limit = index + data.size;
-
-      iterI = itr->second.number;
-      iterL = iterI + itr->second.size;
-      if (!itr->second.size) ++iterL;
-
-      // If either end of the iter's range is in range, try again.
-      if ((iterI >= index && limit > iterI) ||
-          (iterL >  index && limit > iterL))
-      {
-         index = iterL;
-         itr = Table.begin();
-         continue;
-      }
-
-      ++itr;
-   }
-
-   data.number = index;
-}
-
+   return ObjectData::Layout::Before(l->name, l->size, r->name, r->size);
 }
 
 
@@ -141,13 +113,22 @@ void Static::GenerateSymbols()
 {
    ObjectExpression::Pointer obj;
    StaticIter itr, end = Table.end();
+   std::vector<Static *> order;
+   NumberSet numbers;
 
    for(itr = Table.begin(); itr != end; ++itr)
    {
-      if(itr->second.number == -1)
-         SetNumber(itr->second);
+      if(itr->second.number >= 0)
+         numbers.reserve(itr->second.number, itr->second.size);
+      else if(itr->second.number == -1)
+         order.push_back(&itr->second);
    }
 
+   std::stable_sort(order.begin(), order.end(), LayoutLess);
+
+   for(Static *data : order)
+      data->number = numbers.alloc(option_static_offset, data->size);
+
    for(itr = Table.begin(); itr != end; ++itr)
    {
       obj = ObjectExpression::CreateValueUNS(itr->second.number, SourcePosition::none());
@@ -192,6 +173,20 @@ ObjectLoad &Static::Load(ObjectLoad &arc)
    return arc >> Table;
 }
 
+//
+// ObjectData::Static::Retain
+//
+void Static::Retain(std::set<std::string> const &names)
+{
+   for(StaticIter itr = Table.begin(); itr != Table.end();)
+   {
+      if(!itr->second.externDef && !names.count(itr->first))
+         Table.erase(itr++);
+      else
+         ++itr;
+   }
+}
+
 //
 // ObjectData::Static::Save
 //
@@ -27,7 +27,9 @@
 #include "../ObjectExpression.hpp"
 #include "../option.hpp"
 
+#include <algorithm>
 #include <sstream>
+#include <unordered_map>
 
 
 //----------------------------------------------------------------------------|
@@ -37,23 +39,91 @@
 typedef std::map<std::string, ObjectData::String> StringTable;
 typedef StringTable::iterator StringIter;
 
+// Symbol name to string, for Find.
+typedef std::unordered_map<std::string, std::string> NameIndex;
+
+typedef std::vector<ObjectData::String const *> StringOrder;
+
 
 //----------------------------------------------------------------------------|
 // Static Variables                                                           |
 //
 
 static option::option_dptr<bool> option_string_fold_handle
-('\0', "string-fold", "optimization", "Removes duplicate strings.", NULL,
- &option_string_fold);
+('\0', "string-fold", "optimization",
+ "Removes duplicate strings. On by default.", NULL, &option_string_fold);
 
 static StringTable Table;
 
+static NameIndex Index;
+static bool IndexValid = true;
+
+static bigsint NameCount;
+
 
 //----------------------------------------------------------------------------|
 // Global Variables                                                           |
 //
 
-bool option_string_fold = false;
+bool option_string_fold = true;
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// FirstUse
+//
+static bigsint FirstUse(ObjectData::String const *s)
+{
+   bigsint use = ObjectData::Layout::FirstUse(s->names[0]);
+
+   for(auto const &name : s->names)
+      use = std::min(use, ObjectData::Layout::FirstUse(name));
+
+   return use;
+}
+
+//
+// UseCount
+//
+static bigsint UseCount(ObjectData::String const *s)
+{
+   bigsint count = 0;
+
+   for(auto const &name : s->names)
+      count += ObjectData::Layout::UseCount(name);
+
+   return count;
+}
+
+//
+// OrderLess
+//
+// Puts the most used strings first, so that they get the smallest indexes.
+//
+static bool OrderLess(ObjectData::String const *l, ObjectData::String const *r)
+{
+   bigsint countL = UseCount(l), countR = UseCount(r);
+   if(countL != countR) return countL > countR;
+
+   return FirstUse(l) < FirstUse(r);
+}
+
+//
+// MakeOrder
+//
+static void MakeOrder(StringOrder *order)
+{
+   order->clear();
+   order->reserve(Table.size());
+
+   for(StringIter itr = Table.begin(), end = Table.end(); itr != end; ++itr)
+      order->push_back(&itr->second);
+
+   std::stable_sort(order->begin(), order->end(), OrderLess);
+}
 
 
 //----------------------------------------------------------------------------|
@@ -68,20 +138,23 @@ namespace ObjectData
 //
 std::string const &String::Add(std::string const &string)
 {
-   if(Table.count(string))
-      return Table[string].names[0];
-
    String &data = Table[string];
 
+   // Without folding, every literal gets a name, and so an index, of its own.
+   if(!data.names.empty() && option_string_fold)
+      return data.names[0];
+
    data.string = string;
 
    std::ostringstream oss;
-   oss << ObjectExpression::get_filename() << "::0s::" << Table.size();
+   oss << ObjectExpression::get_filename() << "::0s::" << ++NameCount;
    data.names.push_back(oss.str());
 
-   ObjectExpression::add_symbol(data.names[0], ObjectExpression::ET_INT);
+   if(IndexValid) Index[data.names.back()] = string;
 
-   return data.names[0];
+   ObjectExpression::add_symbol(data.names.back(), ObjectExpression::ET_INT);
+
+   return data.names.back();
 }
 
 //
@@ -96,6 +169,8 @@ void String::Add(std::string const &name, std::string const &string)
 
    data.names.push_back(name);
 
+   if(IndexValid) Index[name] = string;
+
    ObjectExpression::add_symbol(name, ObjectExpression::ET_UNS);
 }
 
@@ -104,20 +179,22 @@ void String::Add(std::string const &name, std::string const &string)
 //
 String const *String::Find(std::string const &symbol)
 {
-   StringIter strItr, strEnd;
-   std::vector<std::string>::iterator symItr, symEnd;
-
-   for(strItr = Table.begin(), strEnd = Table.end(); strItr != strEnd; ++strItr)
+   if(!IndexValid)
    {
-      for(symItr = strItr->second.names.begin(), symEnd = strItr->second.names.end();
-          symItr != symEnd; ++symItr)
-      {
-         if(*symItr == symbol)
-            return &strItr->second;
-      }
+      Index.clear();
+
+      for(StringIter itr = Table.begin(), end = Table.end(); itr != end; ++itr)
+         for(auto const &name : itr->second.names)
+            Index[name] = itr->first;
+
+      IndexValid = true;
    }
 
-   return NULL;
+   NameIndex::const_iterator name = Index.find(symbol);
+   if(name == Index.end()) return NULL;
+
+   StringIter itr = Table.find(name->second);
+   return itr == Table.end() ? NULL : &itr->second;
 }
 
 //
@@ -126,18 +203,22 @@ String const *String::Find(std::string const &symbol)
 void String::GenerateSymbols()
 {
    ObjectExpression::Pointer expr;
-   StringIter it;
-   std::vector<std::string>::iterator name;
+   StringOrder order;
    bigsint i = 1;
 
-   for(it = Table.begin(); it != Table.end(); ++it)
-   {
-      String &s = it->second;
+   MakeOrder(&order);
 
+   for(String const *s : order)
+   {
       expr = ObjectExpression::CreateValueUNS(i++, SourcePosition::none());
 
-      for (name = s.names.begin(); name != s.names.end(); ++name)
-         ObjectExpression::add_symbol(*name, expr);
+      for(auto const &name : s->names)
+      {
+         if(!option_string_fold && &name != &s->names[0])
+            expr = ObjectExpression::CreateValueUNS(i++, SourcePosition::none());
+
+         ObjectExpression::add_symbol(name, expr);
+      }
    }
 }
 
@@ -149,8 +230,24 @@ void String::Iterate(IterFunc iterFunc, std::ostream *out)
    static String nullstring = {std::vector<std::string>(), std::string("\0", 1)};
    iterFunc(out, nullstring);
 
-   for(StringIter itr = Table.begin(), end = Table.end(); itr != end; ++itr)
-      iterFunc(out, itr->second);
+   StringOrder order;
+   MakeOrder(&order);
+
+   for(String const *s : order)
+   {
+      if(option_string_fold)
+      {
+         iterFunc(out, *s);
+         continue;
+      }
+
+      // Each name has its own copy, matching GenerateSymbols.
+      for(auto const &name : s->names)
+      {
+         String copy = {std::vector<std::string>(1, name), s->string};
+         iterFunc(out, copy);
+      }
+   }
 }
 
 //
@@ -158,9 +255,32 @@ void String::Iterate(IterFunc iterFunc, std::ostream *out)
 //
 ObjectLoad &String::Load(ObjectLoad &arc)
 {
+   IndexValid = false;
+
    return arc >> Table;
 }
 
+//
+// ObjectData::String::Retain
+//
+void String::Retain(std::set<std::string> const &names)
+{
+   for(StringIter itr = Table.begin(); itr != Table.end();)
+   {
+      bool keep = false;
+
+      for(auto const &name : itr->second.names)
+         if(names.count(name)) keep = true;
+
+      if(keep)
+         ++itr;
+      else
+         Table.erase(itr++);
+   }
+
+   IndexValid = false;
+}
+
 //
 // ObjectData::String::Save
 //
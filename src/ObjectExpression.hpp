@@ -114,10 +114,14 @@ public:
 
 
    virtual bool canResolve() const = 0;
+   virtual bool canResolveSymbol() const {return false;}
 
    virtual void expand(Vector *out) {out->push_back(this);}
    virtual void expandOnce(Vector *out) {out->push_back(this);}
 
+   // Adds every symbol this expression refers to.
+   virtual void findSymbols(std::set<std::string> *) const {}
+
    SourcePosition const &getPosition() const {return pos;}
 
    virtual ExpressionType getType() const = 0;
@@ -26,10 +26,24 @@
 #include "../ObjectArchive.hpp"
 #include "../ObjectData.hpp"
 #include "../ObjectVector.hpp"
+#include "../option.hpp"
+#include "../SourceException.hpp"
 
 #include <cstring>
 
 
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static option::option_data<std::string> option_object_format
+('\0', "object-format", "output",
+ "Sets the format of object output. binary is compact and fast to load, text "
+ "is the original encoding. Both can be read, as can text objects written by "
+ "earlier versions. binary by default.", NULL,
+ "binary");
+
+
 //----------------------------------------------------------------------------|
 // Global Functions                                                           |
 //
@@ -42,9 +56,19 @@ ObjectLoad &ObjectExpression::Load(ObjectLoad &arc, ObjectVector &objects)
    // Format verification.
    char head[7];
    arc >> head;
-   if(std::memcmp(head, "object", 7))
+   if(std::memcmp(head, "object", 6))
       throw __FILE__ ": not object";
 
+   switch(head[6])
+   {
+   case OV_TEXT:   break;
+   case OV_BINARY: arc.setBinary(); break;
+   case OV_TEXT2:  break;
+   default: throw __FILE__ ": unknown object version";
+   }
+
+   arc.setVersion(static_cast<ObjectVersion>(head[6]));
+
    arc >> objects >> library_table >> symbol_table >> symbol_type_table;
 
    ObjectData::Array   ::Load(arc);
@@ -57,6 +81,9 @@ ObjectLoad &ObjectExpression::Load(ObjectLoad &arc, ObjectVector &objects)
    ObjectData::Static  ::Load(arc);
    ObjectData::String  ::Load(arc);
 
+   if(!arc)
+      throw __FILE__ ": truncated or corrupt object";
+
    return arc;
 }
 
@@ -67,7 +94,10 @@ ObjectExpression::Reference ObjectExpression::LoadExpr(ObjectLoad &arc)
 {
    ObjectExpression::ObjectType type;
 
-   switch((arc >> type), type)
+   if(!(arc >> type))
+      throw __FILE__ ": truncated or corrupt object";
+
+   switch(type)
    {
    case OT_UNARY_ADD: return LoadUnaryAdd(arc);
    case OT_UNARY_NOT: return LoadUnaryNot(arc);
@@ -112,7 +142,17 @@ ObjectExpression::Reference ObjectExpression::LoadExpr(ObjectLoad &arc)
 //
 ObjectSave &ObjectExpression::Save(ObjectSave &arc, ObjectVector const &objects)
 {
-   arc << "object" << objects << library_table << symbol_table << symbol_type_table;
+   char head[7] = {'o', 'b', 'j', 'e', 'c', 't', OV_TEXT2};
+
+   if(option_object_format.data == "binary")
+      head[6] = OV_BINARY;
+   else if(option_object_format.data != "text")
+      Error_p("unknown object-format: %s", option_object_format.data.c_str());
+
+   arc << head;
+   if(head[6] == OV_BINARY) arc.setBinary();
+
+   arc << objects << library_table << symbol_table << symbol_type_table;
 
    ObjectData::Array   ::Save(arc);
    ObjectData::ArrayVar::Save(arc);
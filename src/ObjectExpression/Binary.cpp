@@ -72,6 +72,15 @@ bool ObjectExpression_Binary::canResolve() const
    return exprL->canResolve() && exprR->canResolve();
 }
 
+//
+// ObjectExpression_Binary::findSymbols
+//
+void ObjectExpression_Binary::findSymbols(std::set<std::string> *symbols) const
+{
+   exprL->findSymbols(symbols);
+   exprR->findSymbols(symbols);
+}
+
 //
 // ObjectExpression_Binary::getType
 //
@@ -41,6 +41,8 @@ class ObjectExpression_Binary : public ObjectExpression
 public:
    bool canResolve() const;
 
+   virtual void findSymbols(std::set<std::string> *symbols) const;
+
    virtual ExpressionType getType() const;
 
 protected:
@@ -52,6 +52,15 @@ public:
       return exprC->canResolve() && Super::canResolve();
    }
 
+   //
+   // findSymbols
+   //
+   virtual void findSymbols(std::set<std::string> *symbols) const
+   {
+      exprC->findSymbols(symbols);
+      Super::findSymbols(symbols);
+   }
+
    bigreal resolveFIX() const {return (exprC->resolveINT() ? exprL : exprR)->resolveFIX();}
    bigreal resolveFLT() const {return (exprC->resolveINT() ? exprL : exprR)->resolveFLT();}
    bigsint resolveINT() const {return (exprC->resolveINT() ? exprL : exprR)->resolveINT();}
@@ -62,6 +62,14 @@ bool ObjectExpression_Unary::canResolve() const
    return expr->canResolve();
 }
 
+//
+// ObjectExpression_Unary::findSymbols
+//
+void ObjectExpression_Unary::findSymbols(std::set<std::string> *symbols) const
+{
+   expr->findSymbols(symbols);
+}
+
 //
 // ObjectExpression_Unary::getType
 //
@@ -68,6 +68,15 @@ public:
          out->push_back(*iter);
    }
 
+   //
+   // findSymbols
+   //
+   virtual void findSymbols(std::set<std::string> *symbols) const
+   {
+      for(Vector::const_iterator iter = elems.begin(); iter != elems.end(); ++iter)
+         (*iter)->findSymbols(symbols);
+   }
+
    virtual ExpressionType getType() const {return type;}
 
    //
@@ -56,6 +56,19 @@ public:
       return symbol && symbol->canResolve();
    }
 
+   //
+   // canResolveSymbol
+   //
+   virtual bool canResolveSymbol() const {return true;}
+
+   //
+   // findSymbols
+   //
+   virtual void findSymbols(std::set<std::string> *symbols) const
+   {
+      symbols->insert(value);
+   }
+
    //
    // getType
    //
@@ -0,0 +1,376 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Object-level function and script bodies.
+//
+//-----------------------------------------------------------------------------
+
+#include "ObjectFrame.hpp"
+
+#include "ObjectExpression.hpp"
+#include "ObjectToken.hpp"
+#include "ObjectVector.hpp"
+
+#include <algorithm>
+#include <set>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+typedef std::map<std::string, ObjectFrame> FrameTable;
+typedef std::set<std::string> LabelSet;
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static FrameTable Frames;
+
+// Every label in the dynamic jump table, as of the last Split.
+static LabelSet DynamicLabels;
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// AddDynamicLabel
+//
+static void AddDynamicLabel(std::ostream *, ObjectData::Label const &l)
+{
+   DynamicLabels.insert(l.label);
+}
+
+//
+// AddFrameFunction
+//
+static void AddFrameFunction(std::ostream *, ObjectData::Function const &f)
+{
+   if(f.externDef) return;
+
+   ObjectFrame &frame = Frames[f.label];
+   frame.label      = f.label;
+   frame.name       = f.name;
+   frame.argCount   = f.argCount;
+   frame.retCount   = f.retCount;
+   frame.varCount   = f.varCount;
+   frame.inlineType = f.inlineType;
+   frame.frameless  = f.frameless;
+   frame.script     = false;
+}
+
+//
+// AddFrameScript
+//
+static void AddFrameScript(std::ostream *, ObjectData::Script const &s)
+{
+   if(s.externDef) return;
+
+   ObjectFrame &frame = Frames[s.label];
+   frame.label      = s.label;
+   frame.name       = s.name;
+   frame.argCount   = s.argCount;
+   frame.retCount   = s.retCount;
+   frame.varCount   = s.varCount;
+   frame.inlineType = ObjectData::IL_NEVER;
+   frame.frameless  = false;
+   frame.script     = true;
+}
+
+//
+// FindFrame
+//
+static ObjectFrame const *FindFrame(std::vector<std::string> const &labels)
+{
+   for(auto const &label : labels)
+   {
+      FrameTable::const_iterator frame = Frames.find(label);
+
+      if(frame != Frames.end())
+         return &frame->second;
+   }
+
+   return NULL;
+}
+
+//
+// FindTarget
+//
+static bool FindTarget(ObjectFrame::LabelMap const &labels,
+   ObjectExpression const *arg, ObjectFrame::IndexVec *succ)
+{
+   if(!arg->canResolveSymbol()) return false;
+
+   auto label = labels.find(arg->resolveSymbol());
+
+   if(label == labels.end()) return false;
+
+   succ->push_back(label->second);
+   return true;
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// ObjectFrame::ObjectFrame
+//
+ObjectFrame::ObjectFrame() : argCount(0), retCount(0), varCount(0),
+   inlineType(ObjectData::IL_DEFAULT), frameless(false), script(false)
+{
+}
+
+//
+// ObjectFrame::findLabels
+//
+void ObjectFrame::findLabels(LabelMap *labels) const
+{
+   for(std::size_t i = 0, e = tokens.size(); i != e; ++i)
+   {
+      for(auto const &l : tokens[i]->labels)
+         (*labels)[l] = i;
+   }
+}
+
+//
+// ObjectFrame::findLiveness
+//
+void ObjectFrame::findLiveness(std::vector<IndexVec> const &succs,
+   std::vector<bigsint> const &slots, bigsint slotCount,
+   std::vector<LiveSet> *liveIn) const
+{
+   std::size_t count = tokens.size();
+   LiveSet live(slotCount);
+
+   liveIn->assign(count, LiveSet(slotCount, false));
+
+   for(bool changed = true; changed;)
+   {
+      changed = false;
+
+      for(std::size_t i = count; i--;)
+      {
+         std::fill(live.begin(), live.end(), false);
+
+         for(auto succ : succs[i])
+         {
+            LiveSet const &in = (*liveIn)[succ];
+
+            for(bigsint s = 0; s != slotCount; ++s)
+               if(in[s]) live[s] = true;
+         }
+
+         switch(GetRegisterAccess(tokens[i]->code))
+         {
+         case RA_NONE:                           break;
+         case RA_SET:  live[slots[i]] = false; break;
+         case RA_GET:
+         case RA_MOD:  live[slots[i]] = true;  break;
+         }
+
+         if(live != (*liveIn)[i])
+         {
+            (*liveIn)[i].swap(live);
+            changed = true;
+         }
+      }
+   }
+}
+
+//
+// ObjectFrame::findSlots
+//
+bool ObjectFrame::findSlots(std::vector<bigsint> *slots, bigsint *slotCount) const
+{
+   std::size_t count = tokens.size();
+
+   slots->assign(count, -1);
+   *slotCount = argCount;
+
+   for(std::size_t i = 0; i != count; ++i)
+   {
+      if(GetRegisterAccess(tokens[i]->code) == RA_NONE)
+         continue;
+
+      ObjectExpression::Pointer arg = tokens[i]->getArg(0);
+
+      if(!arg->canResolve()) return false;
+
+      bigsint slot = arg->resolveINT();
+
+      if(slot < 0) return false;
+
+      (*slots)[i] = slot;
+      *slotCount = std::max(*slotCount, slot + 1);
+   }
+
+   return true;
+}
+
+//
+// ObjectFrame::findSuccessors
+//
+bool ObjectFrame::findSuccessors(LabelMap const &labels,
+   std::vector<IndexVec> *succs) const
+{
+   std::size_t count = tokens.size();
+
+   succs->assign(count, IndexVec());
+
+   for(std::size_t i = 0; i != count; ++i)
+   {
+      ObjectToken const *token = tokens[i];
+      IndexVec &succ = (*succs)[i];
+      bool next = true;
+
+      switch(token->code)
+      {
+      case OCODE_JMP:
+         // Could go to any label in the table that is in this frame.
+         for(auto const &l : labels)
+            if(DynamicLabels.count(l.first)) succ.push_back(l.second);
+         next = false;
+         break;
+
+      case OCODE_JMP_HLT:
+      case OCODE_JMP_RET:
+      case OCODE_JMP_RET_NIL:
+      case OCODE_JMP_RET_SCR:
+         next = false;
+         break;
+
+      case OCODE_JMP_IMM:
+         if(!FindTarget(labels, token->getArg(0), &succ)) return false;
+         next = false;
+         break;
+
+      case OCODE_JMP_NIL:
+      case OCODE_JMP_TRU:
+         if(!FindTarget(labels, token->getArg(0), &succ)) return false;
+         break;
+
+      case OCODE_JMP_RST:
+         succ.push_back(0);
+         next = false;
+         break;
+
+      case OCODE_JMP_TAB:
+         for(std::size_t j = 1; j < token->args.size(); j += 2)
+            if(!FindTarget(labels, token->args[j], &succ)) return false;
+         break;
+
+      case OCODE_JMP_VAL:
+         if(!FindTarget(labels, token->getArg(1), &succ)) return false;
+         break;
+
+      default:
+         break;
+      }
+
+      if(next && i + 1 != count)
+         succ.push_back(i + 1);
+   }
+
+   return true;
+}
+
+//
+// ObjectFrame::GetRegisterAccess
+//
+ObjectFrame::RegisterAccess ObjectFrame::GetRegisterAccess(ObjectCode code)
+{
+   #define CASE_OP_TYPE(OP,AREA) \
+      case OCODE_##OP##_##AREA##_I: \
+      case OCODE_##OP##_##AREA##_U: \
+      case OCODE_##OP##_##AREA##_X
+
+   #define CASE_OP_AREA(OP) \
+      CASE_OP_TYPE(OP, REG): \
+      CASE_OP_TYPE(OP, TEMP)
+
+   switch(code)
+   {
+   case OCODE_GET_REG:
+   case OCODE_GET_TEMP:
+      return RA_GET;
+
+   case OCODE_SET_REG:
+   case OCODE_SET_TEMP:
+      return RA_SET;
+
+   CASE_OP_AREA(ADD):
+   CASE_OP_AREA(AND):
+   CASE_OP_AREA(DIV):
+   CASE_OP_AREA(IOR):
+   CASE_OP_AREA(LSH):
+   CASE_OP_AREA(MOD):
+   CASE_OP_AREA(MUL):
+   CASE_OP_AREA(RSH):
+   CASE_OP_AREA(SUB):
+   CASE_OP_AREA(XOR):
+   CASE_OP_AREA(DEC):
+   CASE_OP_AREA(INC):
+      return RA_MOD;
+
+   default:
+      return RA_NONE;
+   }
+
+   #undef CASE_OP_AREA
+   #undef CASE_OP_TYPE
+}
+
+//
+// ObjectFrame::Split
+//
+void ObjectFrame::Split(ObjectVector &objects, Vector *frames)
+{
+   ObjectFrame *frame = NULL;
+
+   Frames.clear();
+   ObjectData::Function::Iterate(AddFrameFunction, NULL);
+   ObjectData::Script::Iterate(AddFrameScript, NULL);
+
+   DynamicLabels.clear();
+   ObjectData::Label::Iterate(AddDynamicLabel, NULL);
+
+   frames->clear();
+
+   for(ObjectVector::iterator token = objects.begin(); token != objects.end(); ++token)
+   {
+      if(ObjectFrame const *next = FindFrame(token->labels))
+      {
+         frames->push_back(*next);
+         frame = &frames->back();
+      }
+
+      if(frame) frame->tokens.push_back(token);
+   }
+
+   Frames.clear();
+}
+
+// EOF
+
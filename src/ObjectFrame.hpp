@@ -0,0 +1,103 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Object-level function and script bodies.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef HPP_ObjectFrame_
+#define HPP_ObjectFrame_
+
+#include "bignum.hpp"
+#include "ObjectCode.hpp"
+#include "ObjectData.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+class ObjectToken;
+class ObjectVector;
+
+//
+// ObjectFrame
+//
+// The tokens of a single function or script body, from its entry label up to
+// the next body's entry label.
+//
+class ObjectFrame
+{
+public:
+   enum RegisterAccess
+   {
+      RA_NONE,
+      RA_GET,
+      RA_SET,
+      RA_MOD,
+   };
+
+   typedef std::vector<std::size_t> IndexVec;
+   typedef std::map<std::string, std::size_t> LabelMap;
+   typedef std::vector<bool> LiveSet;
+   typedef std::vector<ObjectFrame> Vector;
+
+
+   ObjectFrame();
+
+   // Maps every label in the body to the index of its token.
+   void findLabels(LabelMap *labels) const;
+
+   // Computes the registers live on entry to each token.
+   void findLiveness(std::vector<IndexVec> const &succs,
+      std::vector<bigsint> const &slots, bigsint slotCount,
+      std::vector<LiveSet> *liveIn) const;
+
+   // Finds the register slot accessed by each token, or -1 for none. Returns
+   // false if any register operand cannot be resolved.
+   bool findSlots(std::vector<bigsint> *slots, bigsint *slotCount) const;
+
+   // Finds the possible successors of each token. Returns false if control
+   // flow cannot be fully determined.
+   bool findSuccessors(LabelMap const &labels,
+      std::vector<IndexVec> *succs) const;
+
+   std::vector<ObjectToken *> tokens;
+   std::string label;
+   std::string name;
+   bigsint argCount;
+   bigsint retCount;
+   bigsint varCount;
+   ObjectData::InlineType inlineType;
+   bool frameless;
+   bool script;
+
+
+   static RegisterAccess GetRegisterAccess(ObjectCode code);
+
+   // Splits objects into the bodies of every defined function and script.
+   static void Split(ObjectVector &objects, Vector *frames);
+};
+
+#endif//HPP_ObjectFrame_
+
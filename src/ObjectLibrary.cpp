@@ -0,0 +1,412 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//
+// Static library archives.
+//
+//-----------------------------------------------------------------------------
+
+#include "ObjectLibrary.hpp"
+
+#include "ObjectArchive.hpp"
+#include "ObjectData.hpp"
+#include "ObjectExpression.hpp"
+#include "ObjectVector.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+typedef std::set<std::string> NameSet;
+
+//
+// LibraryMember
+//
+struct LibraryMember
+{
+   std::string name;
+   std::string data; // The whole object file.
+   NameSet defs;
+   bool loaded;
+};
+
+typedef std::vector<LibraryMember> MemberVector;
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static char const ArchiveHead[8] = {'a', 'r', 'c', 'h', 'i', 'v', 'e', 1};
+
+static MemberVector Members;
+
+static NameSet Names;
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// AddDefArray
+//
+static void AddDefArray(std::ostream *, ObjectData::Array const &a)
+{
+   if(!a.externDef) Names.insert(a.name);
+}
+
+//
+// AddDefArrayVar
+//
+static void AddDefArrayVar(std::ostream *, ObjectData::ArrayVar const &v)
+{
+   if(!v.externDef) Names.insert(v.name);
+}
+
+//
+// AddDefFunction
+//
+static void AddDefFunction(std::ostream *, ObjectData::Function const &f)
+{
+   if(!f.externDef) Names.insert(f.name);
+}
+
+//
+// AddDefRegister
+//
+static void AddDefRegister(std::ostream *, ObjectData::Register const &r)
+{
+   if(!r.externDef) Names.insert(r.name);
+}
+
+//
+// AddDefStatic
+//
+static void AddDefStatic(std::ostream *, ObjectData::Static const &s)
+{
+   if(!s.externDef) Names.insert(s.name);
+}
+
+//
+// AddExtArray
+//
+static void AddExtArray(std::ostream *, ObjectData::Array const &a)
+{
+   if(a.externDef) Names.insert(a.name);
+}
+
+//
+// AddExtArrayVar
+//
+static void AddExtArrayVar(std::ostream *, ObjectData::ArrayVar const &v)
+{
+   if(v.externDef) Names.insert(v.name);
+}
+
+//
+// AddExtFunction
+//
+static void AddExtFunction(std::ostream *, ObjectData::Function const &f)
+{
+   if(f.externDef) Names.insert(f.name);
+}
+
+//
+// AddExtRegister
+//
+static void AddExtRegister(std::ostream *, ObjectData::Register const &r)
+{
+   if(r.externDef) Names.insert(r.name);
+}
+
+//
+// AddExtStatic
+//
+static void AddExtStatic(std::ostream *, ObjectData::Static const &s)
+{
+   if(s.externDef) Names.insert(s.name);
+}
+
+//
+// AddInit
+//
+static void AddInit(ObjectData::Init const &init, NameSet *names)
+{
+   for(auto const &data : init.data)
+      if(data) data->findSymbols(names);
+}
+
+//
+// AddInitArrayVar
+//
+static void AddInitArrayVar(std::ostream *, ObjectData::ArrayVar const &v)
+{
+   AddInit(v.init, &Names);
+}
+
+//
+// AddInitRegister
+//
+static void AddInitRegister(std::ostream *, ObjectData::Register const &r)
+{
+   AddInit(r.init, &Names);
+}
+
+//
+// AddInitStatic
+//
+static void AddInitStatic(std::ostream *, ObjectData::Static const &s)
+{
+   AddInit(s.init, &Names);
+}
+
+//
+// FindDefined
+//
+// Finds every name the loaded objects define.
+//
+static void FindDefined(NameSet *defs)
+{
+   Names.clear();
+
+   ObjectData::Array::IterateMap(AddDefArray, NULL);
+   ObjectData::Array::IterateWorld(AddDefArray, NULL);
+   ObjectData::Array::IterateGlobal(AddDefArray, NULL);
+   ObjectData::ArrayVar::IterateMap(AddDefArrayVar, NULL);
+   ObjectData::ArrayVar::IterateWorld(AddDefArrayVar, NULL);
+   ObjectData::ArrayVar::IterateGlobal(AddDefArrayVar, NULL);
+   ObjectData::Function::Iterate(AddDefFunction, NULL);
+   ObjectData::Register::IterateMap(AddDefRegister, NULL);
+   ObjectData::Register::IterateWorld(AddDefRegister, NULL);
+   ObjectData::Register::IterateGlobal(AddDefRegister, NULL);
+   ObjectData::Static::Iterate(AddDefStatic, NULL);
+
+   defs->swap(Names);
+   Names.clear();
+}
+
+//
+// FindUndefined
+//
+// Finds every name that is referred to and only declared, and every runtime
+// helper that code needs and nothing defines.
+//
+static void FindUndefined(ObjectVector const &objects, NameSet *undefs)
+{
+   NameSet used, externs, helpers;
+
+   for(ObjectVector::const_iterator itr = objects.begin(), end = objects.end();
+       itr != end; ++itr)
+   {
+      for(auto const &arg : itr->args)
+         arg->findSymbols(&used);
+
+      // Helpers are called by lowered code, so they need no declaration.
+      if(char const *helper = ocode_get_helper(itr->code))
+         helpers.insert(helper);
+   }
+
+   Names.clear();
+   ObjectData::ArrayVar::IterateMap(AddInitArrayVar, NULL);
+   ObjectData::ArrayVar::IterateWorld(AddInitArrayVar, NULL);
+   ObjectData::ArrayVar::IterateGlobal(AddInitArrayVar, NULL);
+   ObjectData::Register::IterateMap(AddInitRegister, NULL);
+   ObjectData::Register::IterateWorld(AddInitRegister, NULL);
+   ObjectData::Register::IterateGlobal(AddInitRegister, NULL);
+   ObjectData::Static::Iterate(AddInitStatic, NULL);
+   used.insert(Names.begin(), Names.end());
+
+   Names.clear();
+   ObjectData::Array::IterateMap(AddExtArray, NULL);
+   ObjectData::Array::IterateWorld(AddExtArray, NULL);
+   ObjectData::Array::IterateGlobal(AddExtArray, NULL);
+   ObjectData::ArrayVar::IterateMap(AddExtArrayVar, NULL);
+   ObjectData::ArrayVar::IterateWorld(AddExtArrayVar, NULL);
+   ObjectData::ArrayVar::IterateGlobal(AddExtArrayVar, NULL);
+   ObjectData::Function::Iterate(AddExtFunction, NULL);
+   ObjectData::Register::IterateMap(AddExtRegister, NULL);
+   ObjectData::Register::IterateWorld(AddExtRegister, NULL);
+   ObjectData::Register::IterateGlobal(AddExtRegister, NULL);
+   ObjectData::Static::Iterate(AddExtStatic, NULL);
+   externs.swap(Names);
+
+   undefs->clear();
+
+   for(auto const &name : externs)
+      if(used.count(name)) undefs->insert(name);
+
+   if(!helpers.empty())
+   {
+      NameSet defs;
+      FindDefined(&defs);
+
+      for(auto const &name : helpers)
+         if(!defs.count(name)) undefs->insert(name);
+   }
+}
+
+//
+// LoadMember
+//
+static void LoadMember(LibraryMember const &member, ObjectVector *objects)
+{
+   std::istringstream in(member.data);
+   ObjectLoad arc{in};
+
+   ObjectExpression::Load(arc, *objects);
+}
+
+//
+// ReadFile
+//
+static std::string ReadFile(std::string const &name)
+{
+   std::ifstream in(name.c_str(), std::ios_base::in|std::ios_base::binary);
+
+   if(!in)
+   {
+      std::cerr << "Failed to open '" << name << "' for reading.\n";
+      throw EXIT_FAILURE;
+   }
+
+   return std::string(std::istreambuf_iterator<char>(in),
+                      std::istreambuf_iterator<char>());
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// ObjectLibrary::AddMember
+//
+void ObjectLibrary::AddMember(std::string const &name, ObjectVector *objects)
+{
+   NameSet before, after;
+
+   Members.push_back(LibraryMember());
+   LibraryMember &member = Members.back();
+
+   member.name   = name;
+   member.data   = ReadFile(name);
+   member.loaded = true;
+
+   // Whatever this member makes defined is what it defines.
+   FindDefined(&before);
+   LoadMember(member, objects);
+   FindDefined(&after);
+
+   for(auto const &def : after)
+      if(!before.count(def)) member.defs.insert(def);
+}
+
+//
+// ObjectLibrary::Link
+//
+void ObjectLibrary::Link(ObjectVector *objects)
+{
+   NameSet undefs;
+
+   for(bool loaded = true; loaded;)
+   {
+      loaded = false;
+
+      FindUndefined(*objects, &undefs);
+
+      if(undefs.empty()) break;
+
+      for(auto &member : Members)
+      {
+         if(member.loaded) continue;
+
+         for(auto const &def : member.defs)
+         {
+            if(!undefs.count(def)) continue;
+
+            LoadMember(member, objects);
+            member.loaded = true;
+            loaded = true;
+            break;
+         }
+      }
+   }
+}
+
+//
+// ObjectLibrary::Read
+//
+void ObjectLibrary::Read(std::string const &name)
+{
+   std::istringstream in(ReadFile(name));
+   ObjectLoad arc{in};
+
+   char head[8];
+   arc >> head;
+   if(std::memcmp(head, ArchiveHead, sizeof(head)))
+      throw __FILE__ ": not archive";
+
+   arc.setBinary();
+
+   std::size_t count;
+   arc >> count;
+
+   if(!arc.checkSize(count))
+      throw __FILE__ ": corrupt archive";
+
+   while(count--)
+   {
+      Members.push_back(LibraryMember());
+      LibraryMember &member = Members.back();
+
+      arc >> member.name >> member.defs >> member.data;
+      member.loaded = false;
+   }
+
+   if(!arc)
+      throw __FILE__ ": truncated archive";
+}
+
+//
+// ObjectLibrary::Write
+//
+void ObjectLibrary::Write(std::ostream *out)
+{
+   ObjectSave arc{*out};
+
+   arc << ArchiveHead;
+   arc.setBinary();
+
+   arc << Members.size();
+
+   for(auto const &member : Members)
+      arc << member.name << member.defs << member.data;
+}
+
+// EOF
+
@@ -0,0 +1,60 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+//
+// Static library archives.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef HPP_ObjectLibrary_
+#define HPP_ObjectLibrary_
+
+#include <ostream>
+#include <string>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+class ObjectVector;
+
+//
+// ObjectLibrary
+//
+// Each member of a library is a whole object file, indexed by the symbols it
+// defines. Members are only linked in if something needs one of them.
+//
+struct ObjectLibrary
+{
+   // Loads the object file name into objects and adds it as a member.
+   static void AddMember(std::string const &name, ObjectVector *objects);
+
+   // Loads members until nothing objects refers to is left undefined by them.
+   static void Link(ObjectVector *objects);
+
+   // Reads the members of the archive name.
+   static void Read(std::string const &name);
+
+   // Writes every member added or read as an archive.
+   static void Write(std::ostream *out);
+};
+
+#endif//HPP_ObjectLibrary_
+
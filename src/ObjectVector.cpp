@@ -24,6 +24,7 @@
 #include "ObjectVector.hpp"
 
 #include "ObjectArchive.hpp"
+#include "ObjectData.hpp"
 #include "ObjectExpression.hpp"
 #include "ObjectToken.hpp"
 #include "option.hpp"
@@ -36,6 +37,20 @@
 static option::option_data<bool> option_opt_branch_flip
 ('\0', "opt-branch-flip", "optimization",
  "Inverts conditional branches preceded by a NOT. On by default.", NULL, true);
+static option::option_data<bool> option_opt_frame
+('\0', "opt-frame", "optimization",
+ "Elides auto-stack adjustment around calls that do not need it. On by "
+ "default.", NULL, true);
+static option::option_data<bool> option_opt_icf
+('\0', "opt-icf", "optimization",
+ "Merges functions with identical bodies. On by default.", NULL, true);
+static option::option_data<bool> option_opt_imm
+('\0', "opt-imm", "optimization",
+ "Folds pushed constants into instructions that take immediate operands. On "
+ "by default.", NULL, true);
+static option::option_data<bool> option_opt_inline
+('\0', "opt-inline", "optimization",
+ "Inlines small functions at call sites. On by default.", NULL, true);
 static option::option_data<bool> option_opt_math_nop
 ('\0', "opt-math-nop", "optimization", "Strips mathematical no-ops.", NULL, false);
 static option::option_data<bool> option_opt_nop
@@ -46,6 +61,13 @@ static option::option_data<bool> option_opt_pushdrop
 static option::option_data<bool> option_opt_pushpushswap
 ('\0', "opt-pushpushswap", "optimization",
  "Removes the SWAP from PUSH/PUSH/SWAP sets. On by default.", NULL, true);
+static option::option_data<bool> option_opt_register
+('\0', "opt-register", "optimization",
+ "Reuses local registers for variables with disjoint live ranges. On by "
+ "default.", NULL, true);
+static option::option_data<bool> option_opt_tail
+('\0', "opt-tail", "optimization",
+ "Turns calls in tail position into jumps. On by default.", NULL, true);
 
 
 //----------------------------------------------------------------------------|
@@ -209,6 +231,14 @@ CounterPointer<ObjectExpression> ObjectVector::getValueAdd
 //
 void ObjectVector::optimize()
 {
+   // Function inlining.
+   // Done first so that the inlined code gets the other optimizations.
+   if(option_opt_inline.data) optimize_inline();
+
+   // Call frame elision.
+   // Done after inlining so that inlined bodies are included.
+   if(option_opt_frame.data) optimize_frame();
+
    // NOP removal.
    // Off by default because NOPs do not normally get generated.
    if(option_opt_nop.data) optimize_nop();
@@ -224,6 +254,25 @@ void ObjectVector::optimize()
 
    // PUSH/PUSH/SWAP fixing.
    if(option_opt_pushpushswap.data) optimize_pushpushswap();
+
+   // Immediate operand folding.
+   // Done after the other peepholes, which can leave pushes next to their use.
+   if(option_opt_imm.data) optimize_imm();
+
+   // Local register packing.
+   if(option_opt_register.data) optimize_register();
+
+   // Tail calls.
+   // Done after register packing, which cannot see through the jumps.
+   if(option_opt_tail.data) optimize_tail();
+
+   // Identical code folding.
+   // Done after the others so that bodies are compared in their final form.
+   if(option_opt_icf.data) optimize_icf();
+
+   // Function ordering.
+   // Done after folding so that only the kept bodies are placed.
+   if(ObjectData::Profile::IsUsed()) optimize_layout();
 }
 
 //
@@ -414,6 +463,19 @@ void ObjectVector::optimize_pushpushswap()
    }
 }
 
+//
+// ObjectVector::insToken
+//
+// Inserts token before next.
+//
+void ObjectVector::insToken(ObjectToken *next, ObjectToken *token)
+{
+   token->prev = next->prev;
+   token->next = next;
+   next->prev->next = token;
+   next->prev = token;
+}
+
 //
 // ObjectVector::remToken
 //
@@ -150,12 +150,22 @@ public:
                          static_cast<ObjectExpression *>(getValue(r)));
    }
 
+   void instrument(std::string const &mode, std::ostream *map);
+
    void optimize();
    void optimize_branch_flip();
+   void optimize_frame();
+   void optimize_gc();
+   void optimize_icf();
+   void optimize_imm();
+   void optimize_inline();
+   void optimize_layout();
    void optimize_math_nop();
    void optimize_nop();
    void optimize_pushdrop();
    void optimize_pushpushswap();
+   void optimize_register();
+   void optimize_tail();
 
    void setPosition(SourcePosition const &_pos) {head.pos = _pos;}
 
@@ -166,6 +176,7 @@ public:
 
 private:
    void addToken(ObjectToken *token);
+   void insToken(ObjectToken *next, ObjectToken *token);
    void remToken(ObjectToken *token);
 
    ObjectToken head;
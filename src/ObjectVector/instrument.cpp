@@ -0,0 +1,205 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Execution count instrumentation.
+//
+// A counter increment is inserted at the entry of every function and script,
+// or at the head of every basic block. The counters live in a global or world
+// array of their own, so they persist in savegames and can be read back by the
+// generated dump script, which logs every non-zero counter.
+//
+//-----------------------------------------------------------------------------
+
+#include "../ObjectVector.hpp"
+
+#include "../ObjectData.hpp"
+#include "../ObjectExpression.hpp"
+#include "../ObjectFrame.hpp"
+#include "../option.hpp"
+#include "../ost_type.hpp"
+#include "../SourceException.hpp"
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static option::option_data<int> option_instrument_array
+('\0', "instrument-array", "debugging",
+ "Selects the global or world array to hold instrumentation counters. By "
+ "default, it is allocated like any other array.", NULL, -1);
+
+static option::option_data<bool> option_instrument_world
+('\0', "instrument-world", "debugging",
+ "Keeps instrumentation counters in a world array instead of a global one.",
+ NULL, false);
+
+static std::string const InstrumentArray = "__instrument";
+static std::string const InstrumentDump  = "__instrument_dump";
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// IsBlockHead
+//
+// Returns true if token starts a basic block within its frame.
+//
+static bool IsBlockHead(ObjectToken const *token, ObjectToken const *prev)
+{
+   if(!prev || !token->labels.empty()) return true;
+
+   switch(prev->code)
+   {
+   case OCODE_JMP_NIL:
+   case OCODE_JMP_TAB:
+   case OCODE_JMP_TRU:
+   case OCODE_JMP_VAL:
+      return true;
+
+   default:
+      return false;
+   }
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// ObjectVector::instrument
+//
+void ObjectVector::instrument(std::string const &mode, std::ostream *map)
+{
+   bool const blocks = mode == "blocks";
+
+   if(!blocks && mode != "functions")
+      Error_p("unknown instrument mode: %s", mode.c_str());
+
+   if(Target != TARGET_Eternity && Target != TARGET_ZDoom)
+      Error_p("instrumentation requires global arrays");
+
+   ObjectCode codeInc, codeGet;
+
+   if(option_instrument_world.data)
+   {
+      ObjectData::Array::AddWorld(InstrumentArray, LINKAGE_INTERN, false,
+                                  option_instrument_array.data);
+      codeInc = OCODE_INC_WLDARR_U;
+      codeGet = OCODE_GET_WLDARR;
+   }
+   else
+   {
+      ObjectData::Array::AddGlobal(InstrumentArray, LINKAGE_INTERN, false,
+                                   option_instrument_array.data);
+      codeInc = OCODE_INC_GBLARR_U;
+      codeGet = OCODE_GET_GBLARR;
+   }
+
+   ObjectExpression::Pointer array = getValue(InstrumentArray);
+
+   ObjectFrame::Vector frames;
+   ObjectFrame::Split(*this, &frames);
+
+   *map << "# index kind name position\n";
+
+   bigsint index = 0;
+
+   for(auto const &frame : frames)
+   {
+      ObjectToken *prev = NULL;
+
+      for(ObjectToken *token : frame.tokens)
+      {
+         if(IsBlockHead(token, prev) && (blocks || !prev))
+         {
+            std::vector<std::string> labels;
+            labels.swap(token->labels);
+
+            ObjectExpression::Vector args(1);
+
+            args[0] = getValue(index);
+            insToken(token, new ObjectToken(OCODE_GET_IMM, token->pos, labels, args));
+
+            args[0] = array;
+            labels.clear();
+            insToken(token, new ObjectToken(codeInc, token->pos, labels, args));
+
+            *map << index << ' ';
+
+            if(prev)
+               *map << "block";
+            else
+               *map << (frame.script ? "script" : "function");
+
+            *map << ' ' << frame.name << ' ' << token->pos << '\n';
+
+            ++index;
+         }
+
+         prev = token;
+      }
+   }
+
+   if(!index) return;
+
+   // Dump script. Logs each non-zero counter, from last to first.
+   std::string const label     = InstrumentDump + "::$label";
+   std::string const labelLoop = InstrumentDump + "::$loop";
+   std::string const labelNext = InstrumentDump + "::$next";
+   std::string const str       = ObjectData::String::Add("instrument ");
+
+   ObjectData::Script::Add(InstrumentDump, label, 0, 0, 1, LINKAGE_INTERN, -2,
+                           InstrumentDump);
+
+   setPosition(SourcePosition::builtin());
+
+   addLabel(label);
+   addToken(OCODE_GET_IMM, getValue(index));
+   addToken(OCODE_SET_REG, getValue(0));
+
+   addLabel(labelLoop);
+   addToken(OCODE_DEC_REG_U, getValue(0));
+   addToken(OCODE_GET_REG, getValue(0));
+   addToken(codeGet, array);
+   addToken(OCODE_JMP_NIL, getValue(labelNext));
+
+   addToken(OCODE_ACSP_START);
+   addToken(OCODE_GET_IMM, getValue(str));
+   addToken(OCODE_ACSP_STR);
+   addToken(OCODE_GET_REG, getValue(0));
+   addToken(OCODE_ACSP_NUM_DEC_I);
+   addToken(OCODE_GET_IMM, getValue(' '));
+   addToken(OCODE_ACSP_CHARACTER);
+   addToken(OCODE_GET_REG, getValue(0));
+   addToken(codeGet, array);
+   addToken(OCODE_ACSP_NUM_DEC_I);
+   addToken(OCODE_ACSP_END_LOG);
+
+   addLabel(labelNext);
+   addToken(OCODE_GET_REG, getValue(0));
+   addToken(OCODE_JMP_TRU, getValue(labelLoop));
+   addToken(OCODE_JMP_RET_SCR);
+}
+
+// EOF
+
@@ -0,0 +1,298 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Call frame elision.
+//
+// Every call advances the auto-stack pointer past the caller's automatic
+// variables and resets it afterwards. That is only needed if something in
+// between uses the pointer. A function is frameless if it never uses the
+// pointer, never waits, and only calls frameless functions. Adjustments
+// around calls to frameless functions (or around inlined bodies that are
+// just as well-behaved) are removed.
+//
+//-----------------------------------------------------------------------------
+
+#include "../ObjectVector.hpp"
+
+#include "../ObjectExpression.hpp"
+#include "../ObjectFrame.hpp"
+
+#include <set>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+typedef std::set<std::string> FramelessSet;
+
+//
+// FrameFlow
+//
+struct FrameFlow
+{
+   std::vector<ObjectFrame::IndexVec> preds;
+   std::vector<ObjectFrame::IndexVec> succs;
+   ObjectFrame const *frame;
+   bool valid;
+};
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// IsFrameCode
+//
+// Returns true if code uses the auto-stack or might let another script run.
+//
+static bool IsFrameCode(ObjectCode code)
+{
+   #define CASE_OP_TYPE(OP) \
+      case OCODE_##OP##_AUTO_I: \
+      case OCODE_##OP##_AUTO_U: \
+      case OCODE_##OP##_AUTO_X
+
+   switch(code)
+   {
+   CASE_OP_TYPE(ADD):
+   CASE_OP_TYPE(AND):
+   CASE_OP_TYPE(DIV):
+   CASE_OP_TYPE(IOR):
+   CASE_OP_TYPE(LSH):
+   CASE_OP_TYPE(MOD):
+   CASE_OP_TYPE(MUL):
+   CASE_OP_TYPE(RSH):
+   CASE_OP_TYPE(SUB):
+   CASE_OP_TYPE(XOR):
+   CASE_OP_TYPE(DEC):
+   CASE_OP_TYPE(INC):
+   case OCODE_GET_AUTO:
+   case OCODE_SET_AUTO:
+   case OCODE_GET_AUTPTR:
+   case OCODE_GET_AUTPTR_IMM:
+   case OCODE_SET_AUTPTR:
+   case OCODE_SET_AUTPTR_IMM:
+   case OCODE_ADD_AUTPTR:
+   case OCODE_ADD_AUTPTR_IMM:
+   case OCODE_SUB_AUTPTR:
+   case OCODE_SUB_AUTPTR_IMM:
+   case OCODE_JMP_CAL:
+   case OCODE_JMP_CAL_NIL:
+   case OCODE_ACS_WAIT_POLYOBJECT:
+   case OCODE_ACS_WAIT_POLYOBJECT_IMM:
+   case OCODE_ACS_WAIT_SCRIPT:
+   case OCODE_ACS_WAIT_SCRIPT_IMM:
+   case OCODE_ACS_WAIT_STAG:
+   case OCODE_ACS_WAIT_STAG_IMM:
+   case OCODE_ACS_WAIT_TICS:
+   case OCODE_ACS_WAIT_TICS_IMM:
+   case OCODE_ACSE_WAIT_SNAM:
+      return true;
+
+   default:
+      return false;
+   }
+
+   #undef CASE_OP_TYPE
+}
+
+//
+// IsFrameToken
+//
+static bool IsFrameToken(ObjectToken const *token, FramelessSet const &frameless)
+{
+   if(token->code == OCODE_JMP_CAL_IMM || token->code == OCODE_JMP_CAL_NIL_IMM)
+   {
+      return !token->getArg(0)->canResolveSymbol() ||
+         !frameless.count(token->getArg(0)->resolveSymbol());
+   }
+
+   return IsFrameCode(token->code);
+}
+
+//
+// IsClosed
+//
+// Returns true if control can only enter [begin, end] at begin and only leave
+// it at end.
+//
+static bool IsClosed(FrameFlow const &flow, std::size_t begin, std::size_t end)
+{
+   for(std::size_t i = begin; i != end; ++i)
+   {
+      for(auto succ : flow.succs[i])
+         if(succ <= begin || succ > end) return false;
+
+      for(auto pred : flow.preds[i + 1])
+         if(pred < begin || pred >= end) return false;
+   }
+
+   return true;
+}
+
+//
+// FindElision
+//
+// Marks every auto-stack adjustment that can be removed. Returns true if what
+// is left never needs a frame.
+//
+static bool FindElision(FrameFlow const &flow, FramelessSet const &frameless,
+   std::vector<bool> *elide)
+{
+   std::vector<ObjectToken *> const &tokens = flow.frame->tokens;
+   std::size_t count = tokens.size();
+
+   elide->assign(count, false);
+
+   if(!flow.valid) return false;
+
+   // Each pass can expose enclosing adjustments, so repeat until stable.
+   for(bool changed = true; changed;)
+   {
+      changed = false;
+
+      for(std::size_t i = 0; i != count; ++i)
+      {
+         if((*elide)[i] || tokens[i]->code != OCODE_ADD_AUTPTR_IMM)
+            continue;
+
+         ObjectExpression::Pointer size = tokens[i]->getArg(0);
+         if(!size->canResolve()) continue;
+
+         std::size_t j;
+         for(j = i + 1; j != count; ++j)
+         {
+            if((*elide)[j]) continue;
+
+            if(IsFrameToken(tokens[j], frameless)) break;
+         }
+
+         if(j == count || tokens[j]->code != OCODE_SUB_AUTPTR_IMM)
+            continue;
+
+         if(!tokens[j]->getArg(0)->canResolve() ||
+            tokens[j]->getArg(0)->resolveINT() != size->resolveINT())
+            continue;
+
+         if(!IsClosed(flow, i, j)) continue;
+
+         (*elide)[i] = true;
+         (*elide)[j] = true;
+         changed = true;
+      }
+   }
+
+   for(std::size_t i = 0; i != count; ++i)
+   {
+      if(!(*elide)[i] && IsFrameToken(tokens[i], frameless))
+         return false;
+   }
+
+   return true;
+}
+
+//
+// MakeFlow
+//
+static void MakeFlow(ObjectFrame const &frame, FrameFlow *flow)
+{
+   ObjectFrame::LabelMap labels;
+
+   flow->frame = &frame;
+
+   frame.findLabels(&labels);
+
+   flow->valid = frame.findSuccessors(labels, &flow->succs);
+
+   flow->preds.assign(frame.tokens.size(), ObjectFrame::IndexVec());
+
+   if(flow->valid)
+   {
+      for(std::size_t i = 0, e = flow->succs.size(); i != e; ++i)
+         for(auto succ : flow->succs[i])
+            flow->preds[succ].push_back(i);
+   }
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// ObjectVector::optimize_frame
+//
+// Removes unneeded auto-stack adjustments around calls.
+//
+void ObjectVector::optimize_frame()
+{
+   ObjectFrame::Vector frames;
+   std::vector<FrameFlow> flows;
+   std::vector<bool> elide;
+   FramelessSet frameless;
+
+   ObjectFrame::Split(*this, &frames);
+
+   flows.resize(frames.size());
+   for(std::size_t i = 0, e = frames.size(); i != e; ++i)
+      MakeFlow(frames[i], &flows[i]);
+
+   // Start by assuming every function is frameless, then eliminate those that
+   // are not until nothing changes. This lets recursion be frameless.
+   for(auto const &frame : frames)
+      if(!frame.script) frameless.insert(frame.name);
+
+   for(bool changed = true; changed;)
+   {
+      changed = false;
+
+      for(auto const &flow : flows)
+      {
+         if(!frameless.count(flow.frame->name)) continue;
+
+         if(!FindElision(flow, frameless, &elide))
+         {
+            frameless.erase(flow.frame->name);
+            changed = true;
+         }
+      }
+   }
+
+   for(auto const &name : frameless)
+      ObjectData::Function::SetFrameless(name, true);
+
+   for(auto const &flow : flows)
+   {
+      FindElision(flow, frameless, &elide);
+
+      for(std::size_t i = 0, e = elide.size(); i != e; ++i)
+      {
+         if(!elide[i]) continue;
+
+         ObjectToken *token = flow.frame->tokens[i];
+         token->next->addLabel(token->labels);
+         remToken(token);
+      }
+   }
+}
+
+// EOF
+
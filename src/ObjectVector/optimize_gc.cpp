@@ -0,0 +1,289 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Link-time garbage collection.
+//
+// Starting from scripts and the variables the engine or other modules can
+// see, every symbol reachable through code, initializers, and the symbol
+// table is marked. Functions, statics, internal map variables, strings, and
+// jump table labels that are never reached are then removed before anything
+// is allocated, so they take up neither code nor numbers.
+//
+//-----------------------------------------------------------------------------
+
+#include "../ObjectVector.hpp"
+
+#include "../ObjectExpression.hpp"
+#include "../ObjectFrame.hpp"
+#include "../option.hpp"
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+typedef std::map<std::string, ObjectFrame const *> BodyTable;
+typedef std::map<std::string, ObjectData::Init const *> InitTable;
+typedef std::map<std::string, std::string> NameTable;
+typedef std::set<std::string> NameSet;
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static option::option_data<bool> option_gc_exports
+('\0', "gc-exports", "optimization",
+ "When removing unreachable objects, keeps every function with external "
+ "linkage. Use when the output is a library.", NULL, false);
+
+static BodyTable Bodies;
+static InitTable Inits;
+static NameTable Labels; // Jump table entry to label.
+static NameTable Owners; // Label to enclosing frame.
+
+static NameSet Live;
+static std::vector<std::string> Work;
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// MarkSymbol
+//
+static void MarkSymbol(std::string const &name)
+{
+   if(Live.insert(name).second)
+      Work.push_back(name);
+}
+
+//
+// MarkExpr
+//
+static void MarkExpr(ObjectExpression const *expr)
+{
+   NameSet symbols;
+
+   expr->findSymbols(&symbols);
+
+   for(auto const &symbol : symbols)
+      MarkSymbol(symbol);
+}
+
+//
+// MarkToken
+//
+static void MarkToken(ObjectToken const *token)
+{
+   for(auto const &arg : token->args)
+      MarkExpr(arg);
+
+   if(char const *helper = ocode_get_helper(token->code))
+      MarkSymbol(helper);
+}
+
+//
+// MarkSymbolDefinition
+//
+// Marks everything name depends on.
+//
+static void MarkSymbolDefinition(std::string const &name)
+{
+   if(ObjectExpression::Pointer expr = ObjectExpression::get_symbol_null(name))
+      MarkExpr(expr);
+
+   BodyTable::const_iterator body = Bodies.find(name);
+   if(body != Bodies.end())
+   {
+      for(ObjectToken const *token : body->second->tokens)
+         MarkToken(token);
+   }
+
+   InitTable::const_iterator init = Inits.find(name);
+   if(init != Inits.end())
+   {
+      for(auto const &data : init->second->data)
+         if(data) MarkExpr(data);
+   }
+
+   NameTable::const_iterator label = Labels.find(name);
+   if(label != Labels.end())
+      MarkSymbol(label->second);
+
+   NameTable::const_iterator owner = Owners.find(name);
+   if(owner != Owners.end())
+      MarkSymbol(owner->second);
+}
+
+//
+// RootArrayVar
+//
+static void RootArrayVar(std::ostream *, ObjectData::ArrayVar const &v)
+{
+   Inits[v.name] = &v.init;
+   MarkSymbol(v.name);
+}
+
+//
+// RootArrayVarMap
+//
+static void RootArrayVarMap(std::ostream *, ObjectData::ArrayVar const &v)
+{
+   Inits[v.name] = &v.init;
+
+   // Internal variables are only reachable through this module's code.
+   if(v.linkage != LINKAGE_INTERN || v.externDef)
+      MarkSymbol(v.name);
+}
+
+//
+// RootFunction
+//
+static void RootFunction(std::ostream *, ObjectData::Function const &f)
+{
+   if(option_gc_exports.data && f.linkage != LINKAGE_INTERN)
+      MarkSymbol(f.name);
+}
+
+//
+// RootLabel
+//
+static void RootLabel(std::ostream *, ObjectData::Label const &l)
+{
+   Labels[l.name] = l.label;
+}
+
+//
+// RetainLabel
+//
+// Keeps every jump table entry into live code. A dense switch only refers to
+// the first entry of its table and reaches the rest by offset, so entries
+// cannot be kept by reference alone.
+//
+static void RetainLabel(std::ostream *, ObjectData::Label const &l)
+{
+   NameTable::const_iterator owner = Owners.find(l.label);
+
+   if(owner == Owners.end() || Live.count(owner->second))
+      Live.insert(l.name);
+}
+
+//
+// RootRegister
+//
+static void RootRegister(std::ostream *, ObjectData::Register const &r)
+{
+   Inits[r.name] = &r.init;
+   MarkSymbol(r.name);
+}
+
+//
+// RootScript
+//
+static void RootScript(std::ostream *, ObjectData::Script const &s)
+{
+   MarkSymbol(s.name);
+}
+
+//
+// RootStatic
+//
+static void RootStatic(std::ostream *, ObjectData::Static const &s)
+{
+   Inits[s.name] = &s.init;
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// ObjectVector::optimize_gc
+//
+// Removes functions and data that nothing reachable refers to. Must be done
+// before deferred allocation.
+//
+void ObjectVector::optimize_gc()
+{
+   ObjectFrame::Vector frames;
+
+   ObjectFrame::Split(*this, &frames);
+
+   for(auto const &frame : frames)
+   {
+      Bodies[frame.name] = &frame;
+
+      for(ObjectToken const *token : frame.tokens)
+         for(auto const &label : token->labels)
+            Owners[label] = frame.name;
+   }
+
+   ObjectData::ArrayVar::IterateMap(RootArrayVarMap, NULL);
+   ObjectData::ArrayVar::IterateWorld(RootArrayVar, NULL);
+   ObjectData::ArrayVar::IterateGlobal(RootArrayVar, NULL);
+   ObjectData::Function::Iterate(RootFunction, NULL);
+   ObjectData::Label::Iterate(RootLabel, NULL);
+   ObjectData::Register::Iterate(RootRegister, NULL);
+   ObjectData::Register::IterateMap(RootRegister, NULL);
+   ObjectData::Register::IterateWorld(RootRegister, NULL);
+   ObjectData::Register::IterateGlobal(RootRegister, NULL);
+   ObjectData::Script::Iterate(RootScript, NULL);
+   ObjectData::Static::Iterate(RootStatic, NULL);
+
+   // Anything ahead of the first body is always emitted.
+   ObjectToken const *first = frames.empty() ? &head : frames[0].tokens[0];
+   for(ObjectToken const *token = head.next; token != first; token = token->next)
+      MarkToken(token);
+
+   while(!Work.empty())
+   {
+      std::string name = Work.back();
+      Work.pop_back();
+
+      MarkSymbolDefinition(name);
+   }
+
+   ObjectData::Label::Iterate(RetainLabel, NULL);
+
+   for(auto const &frame : frames)
+   {
+      if(frame.script || Live.count(frame.name)) continue;
+
+      for(ObjectToken *token : frame.tokens)
+         remToken(token);
+   }
+
+   ObjectData::ArrayVar::RetainMap(Live);
+   ObjectData::Function::Retain(Live);
+   ObjectData::Label::Retain(Live);
+   ObjectData::Static::Retain(Live);
+   ObjectData::String::Retain(Live);
+
+   Bodies.clear();
+   Inits.clear();
+   Labels.clear();
+   Owners.clear();
+   Live.clear();
+}
+
+// EOF
+
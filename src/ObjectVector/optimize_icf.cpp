@@ -0,0 +1,199 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Identical code folding.
+//
+// Functions whose final instruction sequences are the same, with references
+// to their own labels taken relative to the body, share one body. The other
+// functions keep their numbers, but their entry labels are moved onto the
+// kept body.
+//
+//-----------------------------------------------------------------------------
+
+#include "../ObjectVector.hpp"
+
+#include "../ObjectExpression.hpp"
+#include "../ObjectFrame.hpp"
+#include "../option.hpp"
+
+#include <iostream>
+#include <sstream>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+typedef std::map<std::string, ObjectFrame const *> BodyTable;
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static option::option_data<bool> option_opt_icf_report
+('\0', "opt-icf-report", "optimization",
+ "Reports how many functions were folded and an estimate of the bytes saved. "
+ "The estimate counts 4 bytes for each instruction and argument, as in "
+ "uncompressed ACS, so it is high for ACSe and compressed encodings.",
+ NULL, false);
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// MakeKeyArg
+//
+// Returns false if arg cannot be compared.
+//
+static bool MakeKeyArg(ObjectFrame::LabelMap const &labels,
+   ObjectExpression const *arg, std::ostream *key)
+{
+   if(arg->canResolveSymbol())
+   {
+      ObjectFrame::LabelMap::const_iterator label = labels.find(arg->resolveSymbol());
+
+      if(label != labels.end())
+      {
+         *key << " L" << label->second;
+         return true;
+      }
+   }
+
+   if(arg->canResolve()) switch(arg->getType())
+   {
+   case ObjectExpression::ET_INT_HH:
+   case ObjectExpression::ET_INT_H:
+   case ObjectExpression::ET_INT:
+   case ObjectExpression::ET_INT_L:
+   case ObjectExpression::ET_INT_LL:
+      *key << " I" << arg->getType() << ':' << arg->resolveINT();
+      return true;
+
+   case ObjectExpression::ET_UNS_HH:
+   case ObjectExpression::ET_UNS_H:
+   case ObjectExpression::ET_UNS:
+   case ObjectExpression::ET_UNS_L:
+   case ObjectExpression::ET_UNS_LL:
+      *key << " U" << arg->getType() << ':' << arg->resolveUNS();
+      return true;
+
+   default:
+      return false;
+   }
+
+   if(arg->canResolveSymbol())
+   {
+      *key << " S" << arg->resolveSymbol();
+      return true;
+   }
+
+   return false;
+}
+
+//
+// MakeKey
+//
+// Returns false if frame cannot be folded.
+//
+static bool MakeKey(ObjectFrame const &frame, std::string *key)
+{
+   if(frame.script || frame.tokens.empty()) return false;
+
+   ObjectFrame::LabelMap labels;
+   std::ostringstream oss;
+
+   frame.findLabels(&labels);
+
+   oss << frame.argCount << ' ' << frame.retCount << ' ' << frame.varCount;
+
+   for(ObjectToken const *token : frame.tokens)
+   {
+      // Dynamic jump table entries are not relative to the body.
+      if(token->code == OCODE_JMP) return false;
+
+      oss << '\n' << token->code;
+
+      for(auto const &arg : token->args)
+         if(!MakeKeyArg(labels, arg, &oss)) return false;
+   }
+
+   *key = oss.str();
+   return true;
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// ObjectVector::optimize_icf
+//
+// Merges functions with identical bodies.
+//
+void ObjectVector::optimize_icf()
+{
+   ObjectFrame::Vector frames;
+   BodyTable bodies;
+   std::string key;
+   bigsint foldCount = 0, tokenCount = 0, byteCount = 0;
+
+   ObjectFrame::Split(*this, &frames);
+
+   for(auto const &frame : frames)
+   {
+      if(!MakeKey(frame, &key)) continue;
+
+      BodyTable::const_iterator body = bodies.find(key);
+
+      if(body == bodies.end())
+      {
+         bodies[key] = &frame;
+         continue;
+      }
+
+      // Calls and jumps to this function now go to the kept body.
+      body->second->tokens[0]->addLabel(frame.tokens[0]->labels);
+
+      for(ObjectToken *token : frame.tokens)
+      {
+         // Estimated as one word for the instruction and one per argument.
+         // The real size depends on the target's encoding, which is not
+         // known until output.
+         byteCount += 4 + 4 * token->args.size();
+         remToken(token);
+      }
+
+      ++foldCount;
+      tokenCount += frame.tokens.size();
+   }
+
+   if(option_opt_icf_report.data)
+   {
+      std::cerr << "icf: folded " << foldCount << " functions, "
+                << tokenCount << " instructions, estimated " << byteCount
+                << " bytes (4 per instruction and argument)\n";
+   }
+}
+
+// EOF
+
@@ -0,0 +1,145 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Immediate operand selection.
+//
+// Many ACS instructions have a form that takes its operands from the code
+// instead of the stack. When every operand is pushed by GET_IMM right before
+// the instruction, the pushes are folded into the immediate form.
+//
+//-----------------------------------------------------------------------------
+
+#include "../ObjectVector.hpp"
+
+#include "../ObjectExpression.hpp"
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// ImmediateForm
+//
+struct ImmediateForm
+{
+   ObjectCode code;
+   ObjectCode codeImm;
+   std::size_t count; // Operands taken from the stack.
+};
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static ImmediateForm const Forms[] =
+{
+   {OCODE_ACS_GAME_GET_THINGCOUNT_SID,  OCODE_ACS_GAME_GET_THINGCOUNT_SID_IMM,  2},
+   {OCODE_ACS_MISC_RANDOM,              OCODE_ACS_MISC_RANDOM_IMM,              2},
+   {OCODE_ACS_SPECIAL_EXEC1,            OCODE_ACS_SPECIAL_EXEC1_IMM,            1},
+   {OCODE_ACS_SPECIAL_EXEC2,            OCODE_ACS_SPECIAL_EXEC2_IMM,            2},
+   {OCODE_ACS_SPECIAL_EXEC3,            OCODE_ACS_SPECIAL_EXEC3_IMM,            3},
+   {OCODE_ACS_SPECIAL_EXEC4,            OCODE_ACS_SPECIAL_EXEC4_IMM,            4},
+   {OCODE_ACS_SPECIAL_EXEC5,            OCODE_ACS_SPECIAL_EXEC5_IMM,            5},
+   {OCODE_ACS_STAG_SET_TEXTURE_CEILING, OCODE_ACS_STAG_SET_TEXTURE_CEILING_IMM, 2},
+   {OCODE_ACS_STAG_SET_TEXTURE_FLOOR,   OCODE_ACS_STAG_SET_TEXTURE_FLOOR_IMM,   2},
+   {OCODE_ACS_WAIT_POLYOBJECT,          OCODE_ACS_WAIT_POLYOBJECT_IMM,          1},
+   {OCODE_ACS_WAIT_SCRIPT,              OCODE_ACS_WAIT_SCRIPT_IMM,              1},
+   {OCODE_ACS_WAIT_STAG,                OCODE_ACS_WAIT_STAG_IMM,                1},
+   {OCODE_ACS_WAIT_TICS,                OCODE_ACS_WAIT_TICS_IMM,                1},
+   {OCODE_ACSE_GAME_SET_AIRCONTROL,     OCODE_ACSE_GAME_SET_AIRCONTROL_IMM,     1},
+   {OCODE_ACSE_GAME_SET_GRAVITY,        OCODE_ACSE_GAME_SET_GRAVITY_IMM,        1},
+   {OCODE_ACSE_GAME_SET_MUSIC,          OCODE_ACSE_GAME_SET_MUSIC_IMM,          3},
+   {OCODE_ACSE_GAME_SET_MUSICLOCAL,     OCODE_ACSE_GAME_SET_MUSICLOCAL_IMM,     3},
+   {OCODE_ACSE_SPAWN_POINT,             OCODE_ACSE_SPAWN_POINT_IMM,             6},
+   {OCODE_ACSE_SPAWN_SPOT_ANGLE,        OCODE_ACSE_SPAWN_SPOT_ANGLE_IMM,        4},
+   {OCODE_ACSE_THING_ADD_INVENTORY,     OCODE_ACSE_THING_ADD_INVENTORY_IMM,     2},
+   {OCODE_ACSE_THING_GET_INVENTORY,     OCODE_ACSE_THING_GET_INVENTORY_IMM,     1},
+   {OCODE_ACSE_THING_SUB_INVENTORY,     OCODE_ACSE_THING_SUB_INVENTORY_IMM,     2},
+   {OCODE_ACSP_SET_FONT,                OCODE_ACSP_SET_FONT_IMM,                1},
+};
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// FindForm
+//
+static ImmediateForm const *FindForm(ObjectCode code)
+{
+   for(ImmediateForm const &form : Forms)
+      if(form.code == code) return &form;
+
+   return NULL;
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// ObjectVector::optimize_imm
+//
+// Folds pushed operands into immediate instruction forms.
+//
+void ObjectVector::optimize_imm()
+{
+   for(iterator token = begin(), stop = end(); token != stop; ++token)
+   {
+      ImmediateForm const *form = FindForm(token->code);
+
+      if(!form || !token->labels.empty()) continue;
+
+      // Only the first push may be jumped to.
+      ObjectToken *first = token;
+      std::size_t count = 0;
+
+      for(; count != form->count; ++count)
+      {
+         if(first != token && !first->labels.empty()) break;
+
+         first = first->prev;
+
+         if(first == &head || first->code != OCODE_GET_IMM) break;
+
+         if(!first->getArg(0)->canResolve()) break;
+      }
+
+      if(count != form->count) continue;
+
+      ObjectExpression::Vector args = token->args;
+
+      for(ObjectToken *push = first; push != token; push = push->next)
+         args.push_back(push->getArg(0));
+
+      token->code = form->codeImm;
+      token->args.swap(args);
+      token->addLabel(first->labels);
+
+      while(token->prev != first->prev)
+         remToken(token->prev);
+   }
+}
+
+// EOF
+
@@ -0,0 +1,359 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Function inlining.
+//
+// Source-level function bodies are bound to the register allocation of their
+// own context, so inlining is done on the final object code. The callee's
+// registers are relocated above the caller's and its returns become jumps to
+// the call's continuation. The auto-stack adjustment around the call is left
+// in place, so automatic variables and multi-word returns work unchanged.
+//
+//-----------------------------------------------------------------------------
+
+#include "../ObjectVector.hpp"
+
+#include "../ObjectExpression.hpp"
+#include "../ObjectFrame.hpp"
+#include "../option.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// InlineBody
+//
+struct InlineBody
+{
+   std::vector<ObjectToken> tokens;
+   std::vector<bigsint> slots;
+   std::vector<bigsint> clear;
+   std::vector<std::string> tail;
+   ObjectFrame::LabelMap labels;
+   bigsint argCount;
+   bigsint retCount;
+   bigsint slotCount;
+};
+
+//
+// InlineSite
+//
+// Accumulates the tokens replacing a call.
+//
+struct InlineSite
+{
+   //
+   // add
+   //
+   void add(ObjectCode code, ObjectExpression::Vector const &args,
+            SourcePosition const &pos)
+   {
+      tokens.push_back(new ObjectToken(code, pos, labels, args));
+      labels.clear();
+   }
+
+   //
+   // add
+   //
+   void add(ObjectCode code, ObjectExpression *arg, SourcePosition const &pos)
+   {
+      add(code, ObjectExpression::Vector(1, arg), pos);
+   }
+
+   std::vector<ObjectToken *> tokens;
+   std::vector<std::string> labels;
+};
+
+typedef std::map<std::string, InlineBody> InlineTable;
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static option::option_data<int> option_opt_inline_size
+('\0', "opt-inline-size", "optimization",
+ "Sets the largest function, in instructions, to inline automatically. "
+ "Functions declared inline may be four times as large. 10 by default.",
+ NULL, 10);
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// MakeBody
+//
+// Returns false if frame cannot or should not be inlined.
+//
+static bool MakeBody(ObjectFrame const &frame, InlineBody *body)
+{
+   if(frame.script || frame.inlineType == ObjectData::IL_NEVER)
+      return false;
+
+   std::vector<ObjectFrame::IndexVec> succs;
+   std::vector<ObjectFrame::LiveSet> liveIn;
+
+   if(!frame.findSlots(&body->slots, &body->slotCount)) return false;
+
+   frame.findLabels(&body->labels);
+
+   if(!frame.findSuccessors(body->labels, &succs)) return false;
+
+   // Strip trailing NOPs. Any labels on them are only reachable by falling
+   // off the end of the body, so they become the call's continuation.
+   std::size_t count = frame.tokens.size();
+   while(count && frame.tokens[count - 1]->code == OCODE_NOP)
+      --count;
+
+   if(!count) return false;
+
+   for(std::size_t i = count; i != frame.tokens.size(); ++i)
+   {
+      for(auto const &label : frame.tokens[i]->labels)
+         body->tail.push_back(label);
+   }
+
+   // Check size and content.
+   bigsint size = 0;
+   for(std::size_t i = 0; i != count; ++i)
+   {
+      ObjectToken const *token = frame.tokens[i];
+
+      switch(token->code)
+      {
+      case OCODE_NOP:
+         continue;
+
+      // Dynamic jump table entries cannot be relocated.
+      case OCODE_JMP:
+      case OCODE_JMP_RET_SCR:
+      case OCODE_JMP_RST:
+         return false;
+
+      case OCODE_JMP_CAL_IMM:
+      case OCODE_JMP_CAL_NIL_IMM:
+         // No self-recursion.
+         if(token->getArg(0)->canResolveSymbol() &&
+            token->getArg(0)->resolveSymbol() == frame.name)
+            return false;
+         break;
+
+      default:
+         break;
+      }
+
+      ++size;
+   }
+
+   switch(frame.inlineType)
+   {
+   case ObjectData::IL_DEFAULT:
+      // Profiled functions are inlined as if hinted if hot, never if cold.
+      if(ObjectData::Profile::IsCold(frame.name)) return false;
+      if(ObjectData::Profile::IsHot(frame.name))
+      {
+         if(size > option_opt_inline_size.data * 4) return false;
+         break;
+      }
+
+      if(size > option_opt_inline_size.data) return false;
+      break;
+
+   case ObjectData::IL_HINT:
+      if(ObjectData::Profile::IsCold(frame.name)) return false;
+      if(size > option_opt_inline_size.data * 4) return false;
+      break;
+
+   case ObjectData::IL_ALWAYS:
+      break;
+
+   case ObjectData::IL_NEVER:
+      return false;
+   }
+
+   // Locals read before being set rely on the engine clearing them.
+   frame.findLiveness(succs, body->slots, body->slotCount, &liveIn);
+   for(bigsint s = frame.argCount; s != body->slotCount; ++s)
+      if(liveIn[0][s]) body->clear.push_back(s);
+
+   body->tokens.reserve(count);
+   for(std::size_t i = 0; i != count; ++i)
+      body->tokens.push_back(*frame.tokens[i]);
+
+   body->argCount = frame.argCount;
+   body->retCount = frame.retCount;
+
+   return true;
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// ObjectVector::optimize_inline
+//
+// Inlines small functions at call sites.
+//
+void ObjectVector::optimize_inline()
+{
+   static ObjectExpression::Vector const argsNone;
+
+   ObjectFrame::Vector frames;
+   InlineTable bodies;
+   bigsint inlineCount = 0;
+
+   ObjectFrame::Split(*this, &frames);
+
+   for(auto const &frame : frames)
+   {
+      InlineBody body;
+
+      if(MakeBody(frame, &body))
+         bodies[frame.name] = body;
+   }
+
+   if(bodies.empty()) return;
+
+   for(auto const &frame : frames)
+   {
+      std::vector<bigsint> slots;
+      bigsint base;
+
+      if(!frame.findSlots(&slots, &base)) continue;
+
+      base = std::max(base, frame.varCount);
+
+      bigsint varCount = base;
+
+      for(ObjectToken *call : frame.tokens)
+      {
+         if(call->code != OCODE_JMP_CAL_IMM && call->code != OCODE_JMP_CAL_NIL_IMM)
+            continue;
+
+         if(!call->getArg(0)->canResolveSymbol() || call->next == &head)
+            continue;
+
+         InlineTable::const_iterator bodyItr = bodies.find(call->getArg(0)->resolveSymbol());
+
+         if(bodyItr == bodies.end() || bodyItr->first == frame.name)
+            continue;
+
+         InlineBody const &body = bodyItr->second;
+         bool drop = call->code == OCODE_JMP_CAL_NIL_IMM;
+
+         // A call expecting a result from a function that returns nothing is
+         // not something to be preserved.
+         if(!drop && !body.retCount) continue;
+
+         std::ostringstream oss;
+         oss << "::$inline" << ++inlineCount;
+         std::string const suffix = oss.str();
+         std::string const labelEnd = bodyItr->first + suffix;
+         bool usedEnd = false;
+
+         InlineSite site;
+         site.labels = call->labels;
+
+         setPosition(call->pos);
+
+         // Move arguments off the stack.
+         for(bigsint i = body.argCount; i--;)
+            site.add(OCODE_SET_REG, getValue(base + i), call->pos);
+
+         for(bigsint s : body.clear)
+         {
+            site.add(OCODE_GET_IMM, getValue(0), call->pos);
+            site.add(OCODE_SET_REG, getValue(base + s), call->pos);
+         }
+
+         for(std::size_t i = 0, e = body.tokens.size(); i != e; ++i)
+         {
+            ObjectToken const &token = body.tokens[i];
+
+            for(auto const &label : token.labels)
+               site.labels.push_back(label + suffix);
+
+            if(token.code == OCODE_JMP_RET || token.code == OCODE_JMP_RET_NIL)
+            {
+               if(token.code == OCODE_JMP_RET && drop)
+                  site.add(OCODE_STK_DROP, argsNone, token.pos);
+
+               // The last return can just fall through to the continuation.
+               if(i + 1 != e)
+               {
+                  site.add(OCODE_JMP_IMM, getValue(labelEnd), token.pos);
+                  usedEnd = true;
+               }
+
+               continue;
+            }
+
+            ObjectExpression::Vector args = token.args;
+
+            if(body.slots[i] != -1)
+               args[0] = getValue(base + body.slots[i]);
+
+            // Relocate references to the body's own labels.
+            for(auto &arg : args)
+            {
+               if(arg->canResolveSymbol() && body.labels.count(arg->resolveSymbol()))
+                  arg = getValue(arg->resolveSymbol() + suffix);
+            }
+
+            site.add(token.code, args, token.pos);
+         }
+
+         for(ObjectToken *token : site.tokens)
+            insToken(call, token);
+
+         // Whatever labels are left, including those from stripped NOPs,
+         // belong to the continuation.
+         for(auto const &label : body.tail)
+            site.labels.push_back(label + suffix);
+
+         if(usedEnd) site.labels.push_back(labelEnd);
+
+         call->next->addLabel(site.labels);
+
+         remToken(call);
+
+         varCount = std::max(varCount, base + body.slotCount);
+      }
+
+      if(varCount != base)
+      {
+         if(frame.script)
+            ObjectData::Script::SetVarCount(frame.name, varCount);
+         else
+            ObjectData::Function::SetVarCount(frame.name, varCount);
+      }
+   }
+}
+
+// EOF
+
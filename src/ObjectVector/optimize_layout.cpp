@@ -0,0 +1,177 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Profile-guided function ordering.
+//
+// Hot functions and scripts are placed together at the front, most entered
+// first, and cold ones at the back. Only bodies that neither fall into the
+// next body nor are fallen into are moved, so control flow is unchanged.
+//
+//-----------------------------------------------------------------------------
+
+#include "../ObjectVector.hpp"
+
+#include "../ObjectFrame.hpp"
+
+#include <algorithm>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// LayoutFrame
+//
+struct LayoutFrame
+{
+   ObjectToken *first;
+   ObjectToken *last;
+   biguint count;
+   int rank;
+};
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// IsClosed
+//
+// Returns true if control cannot pass from last to the token after it.
+// Unlabeled trailing NOPs are unreachable and so are skipped.
+//
+static bool IsClosed(ObjectToken const *last, ObjectToken const *head)
+{
+   while(last != head && last->code == OCODE_NOP && last->labels.empty())
+      last = last->prev;
+
+   if(last == head) return true;
+
+   switch(last->code)
+   {
+   case OCODE_JMP:
+   case OCODE_JMP_HLT:
+   case OCODE_JMP_IMM:
+   case OCODE_JMP_RET:
+   case OCODE_JMP_RET_NIL:
+   case OCODE_JMP_RET_SCR:
+   case OCODE_JMP_RST:
+      return true;
+
+   default:
+      return false;
+   }
+}
+
+//
+// LayoutLess
+//
+static bool LayoutLess(LayoutFrame const &l, LayoutFrame const &r)
+{
+   if(l.rank != r.rank) return l.rank < r.rank;
+
+   // Only hot bodies are ordered by count.
+   if(l.rank == 0) return l.count > r.count;
+
+   return false;
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// ObjectVector::optimize_layout
+//
+// Orders functions and scripts by profile count.
+//
+void ObjectVector::optimize_layout()
+{
+   ObjectFrame::Vector frames;
+   std::vector<LayoutFrame> slots;
+
+   ObjectFrame::Split(*this, &frames);
+
+   for(auto const &frame : frames)
+   {
+      if(frame.tokens.empty()) continue;
+
+      LayoutFrame slot;
+      slot.first = frame.tokens.front();
+      slot.last  = frame.tokens.back();
+
+      if(!IsClosed(slot.first->prev, &head) || !IsClosed(slot.last, &head))
+         continue;
+
+      if(ObjectData::Profile::IsHot(frame.name))
+      {
+         ObjectData::Profile::FindFunction(frame.name, &slot.count);
+         slot.rank = 0;
+      }
+      else
+      {
+         slot.count = 0;
+         slot.rank = ObjectData::Profile::IsCold(frame.name) ? 2 : 1;
+      }
+
+      slots.push_back(slot);
+   }
+
+   std::vector<LayoutFrame> order = slots;
+   std::stable_sort(order.begin(), order.end(), LayoutLess);
+
+   // Mark each slot's place, then unlink every body.
+   std::vector<ObjectToken *> marks;
+   marks.reserve(slots.size());
+
+   for(auto const &slot : slots)
+   {
+      ObjectToken *mark = new ObjectToken;
+      mark->code = OCODE_NOP;
+
+      insToken(slot.first, mark);
+      marks.push_back(mark);
+   }
+
+   for(auto const &slot : slots)
+   {
+      slot.first->prev->next = slot.last->next;
+      slot.last->next->prev = slot.first->prev;
+   }
+
+   // Relink the bodies in their new order, replacing the marks.
+   for(std::size_t i = 0; i != marks.size(); ++i)
+   {
+      ObjectToken *mark = marks[i];
+      LayoutFrame const &slot = order[i];
+
+      slot.first->prev = mark->prev;
+      slot.last->next  = mark;
+      mark->prev->next = slot.first;
+      mark->prev       = slot.last;
+
+      remToken(mark);
+   }
+}
+
+// EOF
+
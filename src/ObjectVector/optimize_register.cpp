@@ -0,0 +1,185 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Local register allocation by live range.
+//
+// Source-level allocation hands out register slots per scope, so variables
+// (and especially temporaries) with disjoint lifetimes never share a slot.
+// This pass computes liveness over each function's and script's object code
+// and repacks the slots using linear scan, lowering the emitted varCount.
+//
+//-----------------------------------------------------------------------------
+
+#include "../ObjectVector.hpp"
+
+#include "../ObjectExpression.hpp"
+#include "../ObjectFrame.hpp"
+
+#include <algorithm>
+#include <set>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// RegisterRange
+//
+struct RegisterRange
+{
+   bool operator < (RegisterRange const &r) const
+   {
+      if(begin != r.begin) return begin < r.begin;
+      return slot < r.slot;
+   }
+
+   std::size_t begin;
+   std::size_t end;
+   bigsint slot;
+};
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// OptimizeFrame
+//
+static void OptimizeFrame(ObjectFrame const &frame)
+{
+   std::size_t count = frame.tokens.size();
+   std::size_t i;
+
+   ObjectFrame::LabelMap labels;
+   std::vector<ObjectFrame::IndexVec> succs;
+   std::vector<ObjectFrame::LiveSet> liveIn;
+   std::vector<bigsint> slots;
+   bigsint slotCount;
+
+   if(!frame.findSlots(&slots, &slotCount)) return;
+
+   frame.findLabels(&labels);
+
+   if(!frame.findSuccessors(labels, &succs)) return;
+
+   frame.findLiveness(succs, slots, slotCount, &liveIn);
+
+   // Build a hull of every point each slot is live or accessed.
+   std::vector<RegisterRange> ranges(slotCount);
+   std::vector<bool> used(slotCount, false);
+
+   for(bigsint s = 0; s != slotCount; ++s)
+   {
+      ranges[s].begin = count;
+      ranges[s].end   = 0;
+      ranges[s].slot  = s;
+   }
+
+   for(i = 0; i != count; ++i)
+   {
+      for(bigsint s = 0; s != slotCount; ++s)
+      {
+         if(!liveIn[i][s] && slots[i] != s) continue;
+
+         ranges[s].begin = std::min(ranges[s].begin, i);
+         ranges[s].end   = std::max(ranges[s].end,   i);
+         used[s] = true;
+      }
+   }
+
+   // Arguments are passed in place and so are live from entry. Keeping them
+   // active at entry also keeps any variable read before being set (and so
+   // relying on the engine clearing locals) out of an argument's slot.
+   for(bigsint s = 0; s != frame.argCount; ++s)
+   {
+      ranges[s].begin = 0;
+      used[s] = true;
+   }
+
+   std::vector<RegisterRange> order;
+   for(bigsint s = 0; s != slotCount; ++s)
+      if(used[s]) order.push_back(ranges[s]);
+
+   std::sort(order.begin(), order.end());
+
+   // Linear scan.
+   std::vector<bigsint> remap(slotCount, -1);
+   std::multimap<std::size_t, bigsint> active;
+   std::set<bigsint> freeSlots;
+   bigsint nextSlot = frame.argCount;
+
+   for(auto const &range : order)
+   {
+      while(!active.empty() && active.begin()->first < range.begin)
+      {
+         freeSlots.insert(active.begin()->second);
+         active.erase(active.begin());
+      }
+
+      bigsint slot;
+
+      if(range.slot < frame.argCount)
+         slot = range.slot;
+      else if(!freeSlots.empty())
+         slot = *freeSlots.begin(), freeSlots.erase(freeSlots.begin());
+      else
+         slot = nextSlot++;
+
+      remap[range.slot] = slot;
+      active.insert(std::make_pair(range.end, slot));
+   }
+
+   for(i = 0; i != count; ++i)
+   {
+      if(slots[i] == -1 || remap[slots[i]] == slots[i]) continue;
+
+      ObjectToken *token = frame.tokens[i];
+      token->args[0] = ObjectExpression::CreateValueINT(remap[slots[i]], token->pos);
+   }
+
+   if(frame.script)
+      ObjectData::Script::SetVarCount(frame.name, nextSlot);
+   else
+      ObjectData::Function::SetVarCount(frame.name, nextSlot);
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// ObjectVector::optimize_register
+//
+// Repacks local register slots by live range.
+//
+void ObjectVector::optimize_register()
+{
+   ObjectFrame::Vector frames;
+
+   ObjectFrame::Split(*this, &frames);
+
+   for(auto const &frame : frames)
+      OptimizeFrame(frame);
+}
+
+// EOF
+
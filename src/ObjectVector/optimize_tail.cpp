@@ -0,0 +1,260 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Tail call optimization.
+//
+// A call immediately followed by a return is replaced by moving the
+// arguments into the caller's registers and jumping to the callee's entry.
+// The callee then returns directly to the caller's caller. For self-calls
+// this turns recursion into a loop.
+//
+//-----------------------------------------------------------------------------
+
+#include "../ObjectVector.hpp"
+
+#include "../ObjectExpression.hpp"
+#include "../ObjectFrame.hpp"
+
+#include <algorithm>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// TailTarget
+//
+struct TailTarget
+{
+   std::string label;
+   std::vector<bigsint> clear;
+   bigsint argCount;
+   bigsint retCount;
+   bigsint varCount;
+};
+
+typedef std::map<std::string, TailTarget> TargetTable;
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// HasAutoAddress
+//
+// Returns true if the frame might let the address of an automatic variable
+// escape, in which case its automatic variables cannot be reused.
+//
+static bool HasAutoAddress(ObjectFrame const &frame)
+{
+   for(ObjectToken const *token : frame.tokens) switch(token->code)
+   {
+   case OCODE_GET_AUTPTR:
+   case OCODE_GET_AUTPTR_IMM:
+   case OCODE_SET_AUTPTR:
+   case OCODE_SET_AUTPTR_IMM:
+   case OCODE_ADD_AUTPTR:
+   case OCODE_SUB_AUTPTR:
+      return true;
+
+   default:
+      break;
+   }
+
+   return false;
+}
+
+//
+// MakeTarget
+//
+// Returns false if frame cannot be jumped to.
+//
+static bool MakeTarget(ObjectFrame const &frame, TailTarget *target)
+{
+   if(frame.script) return false;
+
+   ObjectFrame::LabelMap labels;
+   std::vector<ObjectFrame::IndexVec> succs;
+   std::vector<ObjectFrame::LiveSet> liveIn;
+   std::vector<bigsint> slots;
+   bigsint slotCount;
+
+   if(!frame.findSlots(&slots, &slotCount)) return false;
+
+   frame.findLabels(&labels);
+
+   if(!frame.findSuccessors(labels, &succs)) return false;
+
+   if(frame.tokens.empty()) return false;
+
+   // The caller's registers are not cleared the way a new call's are.
+   frame.findLiveness(succs, slots, slotCount, &liveIn);
+   for(bigsint s = frame.argCount; s != slotCount; ++s)
+      if(liveIn[0][s]) target->clear.push_back(s);
+
+   target->label    = frame.label;
+   target->argCount = frame.argCount;
+   target->retCount = frame.retCount;
+   target->varCount = std::max(frame.varCount, slotCount);
+
+   return true;
+}
+
+
+//
+// MakeToken
+//
+// Creates a token that takes any pending labels.
+//
+static ObjectToken *MakeToken(ObjectCode code, ObjectExpression *arg,
+   SourcePosition const &pos, std::vector<std::string> *labels)
+{
+   ObjectToken *token = new ObjectToken(code, pos, *labels,
+      ObjectExpression::Vector(1, arg));
+
+   labels->clear();
+
+   return token;
+}
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// ObjectVector::optimize_tail
+//
+// Turns calls in tail position into jumps.
+//
+void ObjectVector::optimize_tail()
+{
+   ObjectFrame::Vector frames;
+   TargetTable targets;
+
+   ObjectFrame::Split(*this, &frames);
+
+   for(auto const &frame : frames)
+   {
+      TailTarget target;
+
+      if(MakeTarget(frame, &target))
+         targets[frame.name] = target;
+   }
+
+   if(targets.empty()) return;
+
+   for(auto const &frame : frames)
+   {
+      if(frame.script) continue;
+
+      std::vector<ObjectToken *> const &tokens = frame.tokens;
+      std::size_t count = tokens.size();
+      bool autoAddress = HasAutoAddress(frame);
+      bigsint varCount = frame.varCount;
+
+      for(std::size_t i = 0; i != count; ++i)
+      {
+         ObjectToken *call = tokens[i];
+         ObjectCode codeRet;
+
+         if(call->code == OCODE_JMP_CAL_IMM)
+            codeRet = OCODE_JMP_RET;
+         else if(call->code == OCODE_JMP_CAL_NIL_IMM)
+            codeRet = OCODE_JMP_RET_NIL;
+         else
+            continue;
+
+         if(!call->getArg(0)->canResolveSymbol()) continue;
+
+         TargetTable::const_iterator targetItr = targets.find(call->getArg(0)->resolveSymbol());
+         if(targetItr == targets.end()) continue;
+
+         TailTarget const &target = targetItr->second;
+
+         if(target.retCount != (codeRet == OCODE_JMP_RET ? 1 : 0))
+            continue;
+
+         // The stack-pointer adjustment around the call, if any.
+         ObjectToken *add = NULL, *sub = NULL;
+         std::size_t j = i + 1;
+
+         if(j != count && tokens[j]->code == OCODE_SUB_AUTPTR_IMM)
+         {
+            if(!i || tokens[i - 1]->code != OCODE_ADD_AUTPTR_IMM) continue;
+
+            add = tokens[i - 1];
+            sub = tokens[j++];
+
+            if(!add->getArg(0)->canResolve() || !sub->getArg(0)->canResolve() ||
+               add->getArg(0)->resolveINT() != sub->getArg(0)->resolveINT())
+               continue;
+
+            // The callee will use this frame's automatic variables.
+            if(autoAddress) continue;
+         }
+
+         if(j == count || tokens[j]->code != codeRet) continue;
+
+         ObjectToken *ret = tokens[j];
+
+         // Replace the call with a jump.
+         std::vector<std::string> labels = call->labels;
+
+         for(bigsint a = target.argCount; a--;)
+            insToken(call, MakeToken(OCODE_SET_REG, getValue(a), call->pos, &labels));
+
+         for(bigsint s : target.clear)
+         {
+            insToken(call, MakeToken(OCODE_GET_IMM, getValue(0), call->pos, &labels));
+            insToken(call, MakeToken(OCODE_SET_REG, getValue(s), call->pos, &labels));
+         }
+
+         insToken(call, MakeToken(OCODE_JMP_IMM, getValue(target.label), call->pos, &labels));
+
+         remToken(call);
+
+         if(add)
+         {
+            add->next->addLabel(add->labels);
+            remToken(add);
+         }
+
+         // Anything left is only reachable through its labels.
+         if(sub && sub->labels.empty())
+         {
+            remToken(sub);
+            sub = NULL;
+         }
+
+         if(!sub && ret->labels.empty())
+            remToken(ret);
+
+         varCount = std::max(varCount, target.varCount);
+         i = j;
+      }
+
+      if(varCount != frame.varCount)
+         ObjectData::Function::SetVarCount(frame.name, varCount);
+   }
+}
+
+// EOF
+
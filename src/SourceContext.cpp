@@ -199,7 +199,10 @@ addLabelCase(bigsint value, SourcePosition const &pos)
    if (typeContext == CT_SWITCH)
    {
       if (cases.find(value) == cases.end() || !cases[value])
+      {
          cases[value] = true;
+         caseLines[value] = pos.line;
+      }
       else
          Error_NP("case redefined: " PRI_LL, static_cast<long long int>(value));
 
@@ -460,6 +463,24 @@ SourceContext::AddressSpace const &SourceContext::getAddressSpace(
    Error_NP("no such address-space '%s'", name.c_str());
 }
 
+//
+// SourceContext::getCaseLine
+//
+bigsint SourceContext::getCaseLine(bigsint value, SourcePosition const &pos) const
+{
+   if (typeContext == CT_SWITCH)
+   {
+      std::map<bigsint, bigsint>::const_iterator iter = caseLines.find(value);
+
+      return iter == caseLines.end() ? 0 : iter->second;
+   }
+
+   if (inheritLocals && parent)
+      return parent->getCaseLine(value, pos);
+
+   Error_NP("not CT_SWITCH");
+}
+
 //
 // SourceContext::getCases
 //
@@ -773,6 +794,17 @@ int SourceContext::getLimit(StoreType store) const
    Error_Np("invalid store");
 }
 
+//
+// SourceContext::getNameFunc
+//
+std::string SourceContext::getNameFunc() const
+{
+   if (!nameFunc.empty() || !parent)
+      return nameFunc;
+
+   return parent->getNameFunc();
+}
+
 //
 // SourceContext::getReturnType
 //
@@ -92,6 +92,9 @@ public:
 
    std::vector<bigsint> getCases(SourcePosition const & position) const;
 
+   // Returns the line of value's case label, or 0 if not yet defined.
+   bigsint getCaseLine(bigsint value, SourcePosition const &pos) const;
+
    Reference getContext(std::string const &name, SourcePosition const &pos) const;
    Pointer getContextNull(std::string const &name) const;
 
@@ -117,6 +120,9 @@ public:
 
    int getLimit(StoreType store) const;
 
+   // Returns the object name of the enclosing function or script, if any.
+   std::string getNameFunc() const;
+
    CounterReference<VariableType> getReturnType() const;
 
    CounterPointer<ObjectExpression> getTempVar(unsigned i);
@@ -184,6 +190,8 @@ public:
 
    void setLabel(std::string const &_label) {label = _label;}
 
+   void setNameFunc(std::string const &name) {nameFunc = name;}
+
    void setReturnType(VariableType *type);
 
 
@@ -217,6 +225,7 @@ private:
    void mangleNameObj(std::string &nameObj, std::vector<CounterPointer<VariableType> > const &types);
 
    std::map<bigsint, bool> cases;
+   std::map<bigsint, bigsint> caseLines;
 
    std::set<SourceContext *> children;
 
@@ -243,6 +252,7 @@ private:
    std::vector<CounterPointer<SourceVariable> > varVars;
 
    std::string label;
+   std::string nameFunc;
 
    SourceContext::Pointer parent;
    CounterPointer<VariableType> typeReturn;
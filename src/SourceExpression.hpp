@@ -422,6 +422,7 @@ public:
    SRCEXP_EXPRBRA_DECL(b, ior);
    SRCEXP_EXPRBRA_DECL(b, ior_eq);
    SRCEXP_EXPRBRA_DECL(u, not);
+   SRCEXP_EXPRBRA_DECL(a, printf);
    SRCEXP_EXPRBRA_DECL(u, return);
    SRCEXP_EXPRBRA_DECL(2, switch);
    SRCEXP_EXPRBRA_DECL(2, while);
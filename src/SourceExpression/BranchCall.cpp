@@ -72,6 +72,9 @@ private:
 //
 SRCEXP_EXPRBRA_DEFN(a, call)
 {
+   if(SourceExpression::Pointer call = create_branch_printf(expr, args, context, pos))
+      return call;
+
    return new SourceExpression_BranchCall(expr, args, context, pos);
 }
 
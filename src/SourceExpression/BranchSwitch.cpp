@@ -19,6 +19,15 @@
 //
 // SourceExpression handling of switch blocks.
 //
+// Dispatch is lowered one of four ways, picked by a simple cost model:
+//  linear - A chain of JMP_VAL. Cheap for a handful of cases.
+//  search - One JMP_TAB, which the engine binary searches.
+//  dense  - A range check and a JMP through the dynamic jump table.
+//  tree   - A balanced tree of compares with JMP_VAL chains at the leaves.
+//
+// With a profile, time counts for more in hot functions and not at all in
+// cold ones, and a case taking most executions is tested before the rest.
+//
 //-----------------------------------------------------------------------------
 
 #include "../SourceExpression.hpp"
@@ -26,6 +35,8 @@
 #include "../ObjectExpression.hpp"
 #include "../ObjectVector.hpp"
 #include "../ost_type.hpp"
+#include "../ObjectData.hpp"
+#include "../option.hpp"
 #include "../SourceContext.hpp"
 #include "../VariableData.hpp"
 #include "../VariableType.hpp"
@@ -35,6 +46,30 @@
 // Types                                                                      |
 //
 
+//
+// SwitchLowering
+//
+enum SwitchLowering
+{
+   SL_LINEAR,
+   SL_SEARCH,
+   SL_DENSE,
+   SL_TREE,
+};
+
+//
+// SwitchData
+//
+struct SwitchData
+{
+   std::vector<bigsint> cases;
+   std::string labelDrop;
+   ObjectExpression::Pointer temp;
+   ObjectVector *objects;
+   SourceContext *context;
+   SourcePosition pos;
+};
+
 //
 // SourceExpression_BranchSwitch
 //
@@ -68,6 +103,276 @@ private:
 };
 
 
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static option::option_data<bool> option_opt_switch_dense
+('\0', "opt-switch-dense", "optimization",
+ "Allows switches over a dense range of cases to jump through the dynamic "
+ "jump table. On by default.", NULL, true);
+static option::option_data<bool> option_opt_switch_tree
+('\0', "opt-switch-tree", "optimization",
+ "Allows switches to dispatch through a tree of comparisons. On by default.",
+ NULL, true);
+
+// The number of words of code an executed instruction is considered worth.
+static bigsint const SwitchTimeWeight = 16;
+
+// The largest JMP_VAL chain at the leaves of a compare tree.
+static std::size_t const SwitchTreeLeaf = 4;
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// CeilLog2
+//
+static bigsint CeilLog2(bigsint n)
+{
+   bigsint log = 0;
+
+   while((static_cast<bigsint>(1) << log) < n)
+      ++log;
+
+   return log;
+}
+
+//
+// CostDense
+//
+// Bias, range check, table offset, and jump. One table entry per value.
+//
+static bigsint CostDense(std::vector<bigsint> const &cases, bigsint weight)
+{
+   bigsint range = cases.back() - cases.front() + 1;
+
+   return 9 * weight + 16 + range;
+}
+
+//
+// CostLinear
+//
+// Averaged over every case and the default.
+//
+static bigsint CostLinear(std::vector<bigsint> const &cases, bigsint weight)
+{
+   bigsint n = cases.size();
+   bigsint time = (n * (n + 1) / 2 + n) / (n + 1);
+
+   return time * weight + 3 * n;
+}
+
+//
+// CostSearch
+//
+// Each probe of the engine's search is a data-dependent branch and so counted
+// as costing as much as an instruction.
+//
+static bigsint CostSearch(std::vector<bigsint> const &cases, bigsint weight)
+{
+   bigsint n = cases.size();
+   bigsint time = 1 + CeilLog2(n + 1);
+
+   return time * weight + 2 + 2 * n;
+}
+
+//
+// CostTree
+//
+// Four instructions per compare, then a short JMP_VAL chain.
+//
+static bigsint CostTree(std::vector<bigsint> const &cases, bigsint weight)
+{
+   bigsint n = cases.size();
+   bigsint leaves = (n + SwitchTreeLeaf - 1) / SwitchTreeLeaf;
+   bigsint depth = CeilLog2(leaves);
+   bigsint time = 1 + depth * 4 + 1 + (SwitchTreeLeaf + 1) / 2;
+
+   return time * weight + 2 + (leaves - 1) * 7 + leaves * 4 + 3 * n;
+}
+
+//
+// FindHotCase
+//
+// Returns true if one case was reached more often than all of the others
+// together, according to the profile.
+//
+static bool FindHotCase(SwitchData const &data, std::size_t *hot)
+{
+   std::string nameFunc = data.context->getNameFunc();
+   biguint countHot = 0, countAll = 0;
+
+   for(std::size_t i = 0; i != data.cases.size(); ++i)
+   {
+      bigsint line = data.context->getCaseLine(data.cases[i], data.pos);
+      biguint count;
+
+      if(!ObjectData::Profile::FindBlock(nameFunc, line, &count)) continue;
+
+      countAll += count;
+
+      if(countHot < count)
+         countHot = count, *hot = i;
+   }
+
+   return countHot && countHot * 2 > countAll;
+}
+
+//
+// MakeDense
+//
+// Biasing by INT_MIN turns the unsigned range check into a signed compare.
+//
+static void MakeDense(SwitchData const &data, std::string const &labelDefault)
+{
+   static bigsint const valueMin = -(static_cast<bigsint>(1) << 31);
+   static bigsint const valueMod =   static_cast<bigsint>(1) << 32;
+
+   ObjectVector *objects = data.objects;
+   bigsint lo = data.cases.front(), hi = data.cases.back();
+
+   // Build the jump table. Holes go to default.
+   std::vector<bigsint>::const_iterator caseItr = data.cases.begin();
+   std::string labelBase;
+
+   for(bigsint v = lo; v <= hi; ++v)
+   {
+      std::string label;
+
+      if(v == *caseItr)
+         label = data.context->getLabelCase(*caseItr++, data.pos);
+      else
+         label = labelDefault;
+
+      label = ObjectData::Label::Add(label);
+
+      if(v == lo) labelBase = label;
+   }
+
+   bigsint bias = valueMin - lo;
+   if(bias < valueMin) bias += valueMod;
+
+   objects->addToken(OCODE_GET_IMM, objects->getValue(bias));
+   objects->addToken(OCODE_ADD_STK_I);
+   objects->addToken(OCODE_STK_COPY);
+   objects->addToken(OCODE_GET_IMM, objects->getValue(valueMin + (hi - lo + 1)));
+   objects->addToken(OCODE_CMP_GE_I);
+   objects->addToken(OCODE_JMP_TRU, objects->getValue(data.labelDrop));
+
+   // Adding INT_MIN again removes the bias, modulo 2**32.
+   objects->addToken(OCODE_GET_IMM, objects->getValueAdd(labelBase, valueMin));
+   objects->addToken(OCODE_ADD_STK_I);
+   objects->addToken(OCODE_JMP);
+}
+
+//
+// MakeLinear
+//
+static void MakeLinear(SwitchData const &data, std::size_t begin, std::size_t end)
+{
+   ObjectVector *objects = data.objects;
+
+   for(std::size_t i = begin; i != end; ++i)
+   {
+      bigsint value = data.cases[i];
+
+      objects->addToken(OCODE_JMP_VAL, objects->getValue(value),
+         objects->getValue(data.context->getLabelCase(value, data.pos)));
+   }
+}
+
+//
+// MakeSearch
+//
+static void MakeSearch(SwitchData const &data)
+{
+   ObjectVector *objects = data.objects;
+   ObjectExpression::Vector args;
+
+   args.reserve(data.cases.size() * 2);
+
+   for(auto value : data.cases)
+   {
+      args.push_back(objects->getValue(value));
+      args.push_back(objects->getValue(data.context->getLabelCase(value, data.pos)));
+   }
+
+   objects->addToken(OCODE_JMP_TAB, args);
+}
+
+//
+// MakeTree
+//
+// The condition is kept in a temporary register so that this works for
+// targets without STK_COPY.
+// Every leaf but the last needs to jump to the final drop.
+//
+static void MakeTree(SwitchData const &data, std::size_t begin, std::size_t end,
+   bool last)
+{
+   ObjectVector *objects = data.objects;
+
+   if(end - begin <= SwitchTreeLeaf)
+   {
+      objects->addToken(OCODE_GET_TEMP, data.temp);
+      MakeLinear(data, begin, end);
+
+      if(!last)
+         objects->addToken(OCODE_JMP_IMM, objects->getValue(data.labelDrop));
+
+      return;
+   }
+
+   std::size_t mid = begin + (end - begin) / 2;
+   std::string labelHigh = data.context->makeLabel();
+
+   objects->addToken(OCODE_GET_TEMP, data.temp);
+   objects->addToken(OCODE_GET_IMM, objects->getValue(data.cases[mid]));
+   objects->addToken(OCODE_CMP_GE_I);
+   objects->addToken(OCODE_JMP_TRU, objects->getValue(labelHigh));
+
+   MakeTree(data, begin, mid, false);
+
+   objects->addLabel(labelHigh);
+   MakeTree(data, mid, end, last);
+}
+
+//
+// SelectLowering
+//
+static SwitchLowering SelectLowering(std::vector<bigsint> const &cases,
+   bigsint weight)
+{
+   SwitchLowering lowering = SL_LINEAR;
+   bigsint cost = CostLinear(cases, weight), costNext;
+
+   if(cases.empty()) return lowering;
+
+   // Hexen has neither JMP_TAB nor a dynamic jump.
+   if(Target != TARGET_Hexen)
+   {
+      if((costNext = CostSearch(cases, weight)) < cost)
+         lowering = SL_SEARCH, cost = costNext;
+
+      // The dynamic jump table is only written for ACSE.
+      if(option_opt_switch_dense.data &&
+         (Target == TARGET_Eternity || Target == TARGET_ZDoom) &&
+         cases.back() - cases.front() < 0x10000 &&
+         (costNext = CostDense(cases, weight)) < cost)
+         lowering = SL_DENSE, cost = costNext;
+   }
+
+   if(option_opt_switch_tree.data && cases.size() > SwitchTreeLeaf &&
+      (costNext = CostTree(cases, weight)) < cost)
+      lowering = SL_TREE, cost = costNext;
+
+   return lowering;
+}
+
+
 //----------------------------------------------------------------------------|
 // Global Functions                                                           |
 //
@@ -123,35 +428,58 @@ virtual_makeObjects(ObjectVector *objects, VariableData *dst)
    std::vector<bigsint> cases = context->getCases(pos);
    std::string caseDefault = context->getLabelCaseDefault(pos);
 
-   std::vector<bigsint>::iterator caseItr, caseEnd = cases.end();
+   SwitchData data;
+   data.cases   = cases;
+   data.objects = objects;
+   data.context = context;
+   data.pos     = pos;
 
-   // Generate jump table.
-   if(cases.size() < 4 || Target == TARGET_Hexen)
-   {
-      // Linear search via JMP_VAL.
+   // Weigh time by how hot the function is.
+   std::string nameFunc = context->getNameFunc();
+   bigsint weight = SwitchTimeWeight;
 
-      // Fall back to this for very small tables, since it is probably faster.
-      // Or for Hexen which only has this method.
+   if(ObjectData::Profile::IsCold(nameFunc))
+      weight = 0;
+   else if(ObjectData::Profile::IsHot(nameFunc))
+      weight = SwitchTimeWeight * 4;
 
-      for(caseItr = cases.begin(); caseItr != caseEnd; ++caseItr)
-         objects->addToken(OCODE_JMP_VAL, objects->getValue(*caseItr),
-                           objects->getValue(context->getLabelCase(*caseItr, pos)));
-   }
-   else
+   // Test the hottest case by itself, then dispatch the rest.
+   std::size_t hot;
+   if(ObjectData::Profile::IsUsed() && FindHotCase(data, &hot))
    {
-      // Binary search via JMP_TAB.
+      bigsint value = cases[hot];
 
-      ObjectExpression::Vector args;
-      args.reserve(cases.size() * 2);
+      objects->addToken(OCODE_JMP_VAL, objects->getValue(value),
+         objects->getValue(context->getLabelCase(value, pos)));
 
-      for(caseItr = cases.begin(); caseItr != caseEnd; ++caseItr)
-      {
-         args.push_back(objects->getValue(*caseItr));
-         args.push_back(objects->getValue(context->getLabelCase(*caseItr, pos)));
-      }
+      cases.erase(cases.begin() + hot);
+      data.cases = cases;
+   }
 
-      // Generate jump table.
-      objects->addToken(OCODE_JMP_TAB, args);
+   // Generate dispatch.
+   switch(SelectLowering(cases, weight))
+   {
+   case SL_LINEAR:
+      MakeLinear(data, 0, cases.size());
+      break;
+
+   case SL_SEARCH:
+      MakeSearch(data);
+      break;
+
+   case SL_DENSE:
+      data.labelDrop = context->makeLabel();
+      MakeDense(data, caseDefault);
+      objects->addLabel(data.labelDrop);
+      break;
+
+   case SL_TREE:
+      data.labelDrop = context->makeLabel();
+      data.temp = context->getTempVar(0);
+      objects->addToken(OCODE_SET_TEMP, data.temp);
+      MakeTree(data, 0, cases.size(), true);
+      objects->addLabel(data.labelDrop);
+      break;
    }
 
    objects->addToken(OCODE_STK_DROP);
@@ -57,24 +57,39 @@ private:
    //
    // ::doChar
    //
-   void doChar(ObjectVector *objects, char c) const
+   void doChar(char c)
    {
-      objects->addToken(OCODE_GET_IMM, objects->getValue(c));
-      objects->addToken(OCODE_ACSP_CHARACTER);
+      text += c;
    }
 
    //
    // ::doChar
    //
-   void doChar(ObjectVector *objects, char const *s) const
+   void doChar(char const *s)
    {
-      while (*s) doChar(objects, *s++);
+      text += s;
    }
 
-   void doOut(ObjectVector *objects, VariableType *type) const;
+   void doOut(ObjectVector *objects, VariableType *type);
+
+   void doText(ObjectVector *objects);
+
+   //
+   // ::doToken
+   //
+   // Prints any text before the next print token.
+   //
+   void doToken(ObjectVector *objects, ObjectCode code)
+   {
+      doText(objects);
+      objects->addToken(code);
+   }
 
    virtual void virtual_makeObjects(ObjectVector *objects, VariableData *dst);
 
+   // Text not yet printed, so that runs of it print as one string.
+   std::string text;
+
    SourceExpression::Pointer expr;
 };
 
@@ -104,7 +119,7 @@ SourceExpression_RootOutput::SourceExpression_RootOutput(SRCEXP_EXPRUNA_PARM)
 // SourceExpression_RootOutput::doOut
 //
 void SourceExpression_RootOutput::doOut
-(ObjectVector *objects, VariableType *type) const
+(ObjectVector *objects, VariableType *type)
 {
    VariableType::BasicType bt = type->getBasicType();
    VariableType::Vector const *types;
@@ -112,43 +127,43 @@ void SourceExpression_RootOutput::doOut
    switch (bt)
    {
    case VariableType::BT_VOID:
-      doChar(objects, 'V');
+      doChar('V');
       break;
 
    case VariableType::BT_BIT_HRD:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, 'B');
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar('B');
       break;
 
    case VariableType::BT_BIT_SFT:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, "BS");
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar("BS");
       break;
 
    case VariableType::BT_CHR:
-      doChar(objects, '\'');
-      objects->addToken(OCODE_ACSP_CHARACTER);
-      doChar(objects, '\'');
+      doChar('\'');
+      doToken(objects, OCODE_ACSP_CHARACTER);
+      doChar('\'');
       break;
 
    case VariableType::BT_CLX:
-      doChar(objects, "C{");
+      doChar("C{");
       doOut(objects, type->getTypes()[1]);
-      doChar(objects, ' ');
+      doChar(' ');
       doOut(objects, type->getTypes()[0]);
-      doChar(objects, '}');
+      doChar('}');
       break;
 
    case VariableType::BT_CLX_IM:
-      doChar(objects, "I{");
+      doChar("I{");
       doOut(objects, type->getTypes()[0]);
-      doChar(objects, '}');
+      doChar('}');
       break;
 
    case VariableType::BT_SAT:
-      doChar(objects, "S{");
+      doChar("S{");
       doOut(objects, type->getTypes()[0]);
-      doChar(objects, '}');
+      doChar('}');
       break;
 
    case VariableType::BT_ACC_HH:
@@ -166,18 +181,18 @@ void SourceExpression_RootOutput::doOut
       Error_NP("unsupported BT: %s", make_string(bt).c_str());
 
    case VariableType::BT_FIX_HH:
-      objects->addToken(OCODE_ACSP_NUM_DEC_X);
-      doChar(objects, "XHH");
+      doToken(objects, OCODE_ACSP_NUM_DEC_X);
+      doChar("XHH");
       break;
 
    case VariableType::BT_FIX_H:
-      objects->addToken(OCODE_ACSP_NUM_DEC_X);
-      doChar(objects, "XH");
+      doToken(objects, OCODE_ACSP_NUM_DEC_X);
+      doChar("XH");
       break;
 
    case VariableType::BT_FIX:
-      objects->addToken(OCODE_ACSP_NUM_DEC_X);
-      doChar(objects, 'X');
+      doToken(objects, OCODE_ACSP_NUM_DEC_X);
+      doChar('X');
       break;
 
    case VariableType::BT_FIX_L:
@@ -199,78 +214,78 @@ void SourceExpression_RootOutput::doOut
       Error_NP("unsupported BT: %s", make_string(bt).c_str());
 
    case VariableType::BT_INT_HH:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, "IHH");
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar("IHH");
       break;
 
    case VariableType::BT_INT_H:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, "IH");
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar("IH");
       break;
 
    case VariableType::BT_INT:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, 'I');
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar('I');
       break;
 
    case VariableType::BT_INT_L:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, "IL");
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar("IL");
       break;
 
    case VariableType::BT_INT_LL:
-      objects->addToken(OCODE_ACSP_NUM_HEX_U);
-      doChar(objects, ' ');
-      objects->addToken(OCODE_ACSP_NUM_HEX_U);
-      doChar(objects, "ILL");
+      doToken(objects, OCODE_ACSP_NUM_HEX_U);
+      doChar(' ');
+      doToken(objects, OCODE_ACSP_NUM_HEX_U);
+      doChar("ILL");
       break;
 
    case VariableType::BT_UNS_HH:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, "UHH");
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar("UHH");
       break;
 
    case VariableType::BT_UNS_H:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, "UH");
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar("UH");
       break;
 
    case VariableType::BT_UNS:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, 'U');
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar('U');
       break;
 
    case VariableType::BT_UNS_L:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, "UL");
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar("UL");
       break;
 
    case VariableType::BT_UNS_LL:
-      objects->addToken(OCODE_ACSP_NUM_HEX_U);
-      doChar(objects, ' ');
-      objects->addToken(OCODE_ACSP_NUM_HEX_U);
-      doChar(objects, "ULL");
+      doToken(objects, OCODE_ACSP_NUM_HEX_U);
+      doChar(' ');
+      doToken(objects, OCODE_ACSP_NUM_HEX_U);
+      doChar("ULL");
       break;
 
    case VariableType::BT_LABEL:
-      objects->addToken(OCODE_ACSP_NUM_HEX_U);
-      doChar(objects, 'L');
+      doToken(objects, OCODE_ACSP_NUM_HEX_U);
+      doChar('L');
       break;
 
    case VariableType::BT_STR:
-      doChar(objects, '"');
-      objects->addToken(OCODE_ACSP_STR);
-      doChar(objects, '"');
+      doChar('"');
+      doToken(objects, OCODE_ACSP_STR);
+      doChar('"');
       break;
 
    case VariableType::BT_ARR:
-      doChar(objects, "A{");
+      doChar("A{");
       for (bigsint i = type->getWidth(); i--;)
       {
          doOut(objects, type->getReturn());
-         if (i) doChar(objects, ' ');
+         if (i) doChar(' ');
       }
-      doChar(objects, "}A");
+      doChar("}A");
       break;
 
    case VariableType::BT_PTR:
@@ -280,85 +295,110 @@ void SourceExpression_RootOutput::doOut
       }
       else for(biguint i = type->getSize(pos); i--;)
       {
-         objects->addToken(OCODE_ACSP_NUM_HEX_U);
-         if(i) doChar(objects, ' ');
+         doToken(objects, OCODE_ACSP_NUM_HEX_U);
+         if(i) doChar(' ');
       }
-      doChar(objects, 'P');
+      doChar('P');
       break;
 
    case VariableType::BT_PTR_NUL:
-      objects->addToken(OCODE_ACSP_NUM_HEX_U);
-      doChar(objects, "PN");
+      doToken(objects, OCODE_ACSP_NUM_HEX_U);
+      doChar("PN");
       break;
 
    case VariableType::BT_ENUM:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, 'E');
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar('E');
       break;
 
    case VariableType::BT_STRUCT:
-      doChar(objects, "S{");
+      doChar("S{");
       for (size_t i = (types = &type->getTypes())->size(); i--;)
       {
          doOut(objects, (*types)[i]);
-         if (i) doChar(objects, ' ');
+         if (i) doChar(' ');
       }
-      doChar(objects, "}S");
+      doChar("}S");
       break;
 
    case VariableType::BT_UNION:
-      doChar(objects, "U{");
+      doChar("U{");
       for (bigsint i = type->getSize(pos); i--;)
       {
-         objects->addToken(OCODE_ACSP_NUM_HEX_U);
-         if (i) doChar(objects, ' ');
+         doToken(objects, OCODE_ACSP_NUM_HEX_U);
+         if (i) doChar(' ');
       }
-      doChar(objects, "}U");
+      doChar("}U");
 
       break;
 
    case VariableType::BT_BLOCK:
-      doChar(objects, "B{");
+      doChar("B{");
       for (size_t i = (types = &type->getTypes())->size(); i--;)
       {
          doOut(objects, (*types)[i]);
-         if (i) doChar(objects, ' ');
+         if (i) doChar(' ');
       }
-      doChar(objects, "}B");
+      doChar("}B");
       break;
 
    case VariableType::BT_FUN:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, 'f');
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar('f');
       break;
 
    case VariableType::BT_FUN_ASM:
-      doChar(objects, "fA");
+      doChar("fA");
       break;
 
    case VariableType::BT_FUN_LIN:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, "fL");
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar("fL");
       break;
 
    case VariableType::BT_FUN_NAT:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, "fN");
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar("fN");
       break;
 
    case VariableType::BT_FUN_SNA:
-      doChar(objects, '"');
-      objects->addToken(OCODE_ACSP_STR);
-      doChar(objects, "\"fSa");
+      doChar('"');
+      doToken(objects, OCODE_ACSP_STR);
+      doChar("\"fSa");
       break;
 
    case VariableType::BT_FUN_SNU:
-      objects->addToken(OCODE_ACSP_NUM_DEC_I);
-      doChar(objects, "fSu");
+      doToken(objects, OCODE_ACSP_NUM_DEC_I);
+      doChar("fSu");
       break;
    }
 
-   doChar(objects, ';');
+   doChar(';');
+}
+
+//
+// SourceExpression_RootOutput::doText
+//
+// Prints the pending text. A lone character is printed as such, and anything
+// longer as a string literal, which takes fewer instructions from two on.
+//
+void SourceExpression_RootOutput::doText(ObjectVector *objects)
+{
+   if(text.size() == 1)
+   {
+      objects->addToken(OCODE_GET_IMM, objects->getValue(text[0]));
+      objects->addToken(OCODE_ACSP_CHARACTER);
+   }
+   else if(!text.empty())
+   {
+      VariableType::Reference type = VariableType::get_bt_str();
+
+      create_value_string(text, context, pos)->makeObjects
+         (objects, VariableData::create_stack(type->getSize(pos)));
+      objects->addToken(OCODE_ACSP_STR);
+   }
+
+   text.clear();
 }
 
 //
@@ -379,9 +419,9 @@ void SourceExpression_RootOutput::virtual_makeObjects
    doOut(objects, expr->getType());
 
    if(Target == TARGET_Hexen)
-      objects->addToken(OCODE_ACSP_END);
+      doToken(objects, OCODE_ACSP_END);
    else
-      objects->addToken(OCODE_ACSP_END_LOG);
+      doToken(objects, OCODE_ACSP_END_LOG);
 }
 
 // EOF
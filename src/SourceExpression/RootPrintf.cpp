@@ -23,12 +23,19 @@
 
 #include "../SourceExpression.hpp"
 
+#include "../ObjectData.hpp"
 #include "../ObjectExpression.hpp"
 #include "../ObjectVector.hpp"
+#include "../option.hpp"
+#include "../ost_type.hpp"
 #include "../SourceException.hpp"
+#include "../SourceFunction.hpp"
+#include "../SourceVariable.hpp"
 #include "../VariableData.hpp"
 #include "../VariableType.hpp"
 
+#include <cstring>
+
 
 //----------------------------------------------------------------------------|
 // Types                                                                      |
@@ -93,6 +100,10 @@ public:
       bigsint      prec;
       FormatLength len;
       char         fmt;
+
+      // Arguments for * width and precision, read in format order.
+      SourceExpression::Pointer widthExpr;
+      SourceExpression::Pointer precExpr;
    };
 
 
@@ -346,6 +357,21 @@ private:
 
       if(argBT == VariableType::BT_STR)
       {
+         // For custom print rules, cast to far*.
+         if(data.flags || data.width || data.prec)
+         {
+            argType = VariableType::get_bt_chr()
+                      ->addQualifier(VariableType::QUAL_CONST)
+                      ->setStorage(STORE_FAR)
+                      ->getPointer();
+            argExpr = create_value_cast_implicit(argExpr, argType, context, pos);
+
+            makeData(objects, data);
+            makeExpr(objects, argExpr);
+            objects->addToken(OCODE_JMP_CAL_NIL_IMM, objects->getValue("__Print_s"));
+            return;
+         }
+
          argExpr->makeObjects(objects, tmp);
          objects->addToken(OCODE_ACSP_STR);
          return;
@@ -481,6 +507,63 @@ private:
       }
    }
 
+   //
+   // ::doFormatConstant
+   //
+   // Adds the next argument to the literal text if it is a constant character
+   // or string printed without custom rules, so that it prints with the text
+   // around it.
+   //
+   bool doFormatConstant(FormatData &data, std::string &s)
+   {
+      if(data.flags || data.width || data.prec || !*expr) return false;
+
+      switch(data.fmt)
+      {
+      case 'c':
+      {
+         SourceExpression::Pointer argExpr =
+            create_value_cast_implicit(*expr, VariableType::get_bt_chr(), context, pos);
+
+         if(!argExpr->canMakeObject()) return false;
+
+         ObjectExpression::Pointer argObj = argExpr->makeObject();
+         if(!argObj->canResolve()) return false;
+
+         bigsint c = argObj->resolveINT();
+         if(c <= 0 || c > 127) return false;
+
+         s += static_cast<char>(c);
+      }
+         break;
+
+      case 's':
+      {
+         SourceExpression::Pointer argExpr = *expr;
+
+         if(argExpr->getType()->getBasicType() != VariableType::BT_STR ||
+            !argExpr->canMakeObject())
+            return false;
+
+         ObjectExpression::Pointer argObj = argExpr->makeObject();
+         if(!argObj->canResolveSymbol()) return false;
+
+         ObjectData::String const *str =
+            ObjectData::String::Find(argObj->resolveSymbol());
+         if(!str) return false;
+
+         s += str->string;
+      }
+         break;
+
+      default:
+         return false;
+      }
+
+      ++expr;
+      return true;
+   }
+
    //
    // ::doFormatLiteral
    //
@@ -531,12 +614,12 @@ private:
       makeInt(objects, data.flags);
 
       if(data.width == -1)
-         makeExpr(objects, VariableType::get_bt_int());
+         makeExpr(objects, data.widthExpr);
       else
          makeInt(objects, data.width);
 
       if(data.prec == -1)
-         makeExpr(objects, VariableType::get_bt_int());
+         makeExpr(objects, data.precExpr);
       else
          makeInt(objects, data.prec);
 
@@ -546,14 +629,24 @@ private:
    //
    // ::makeExpr
    //
-   // Evaluates the next expression onto the stack.
+   // Evaluates an expression onto the stack.
    //
-   void makeExpr(ObjectVector *objects, VariableType *type)
+   void makeExpr(ObjectVector *objects, SourceExpression *e)
    {
       VariableData::Pointer tmp =
-         VariableData::create_stack(type->getSize(pos));
+         VariableData::create_stack(e->getType()->getSize(pos));
 
-      nextExpr(type)->makeObjects(objects, tmp);
+      e->makeObjects(objects, tmp);
+   }
+
+   //
+   // ::makeExpr
+   //
+   // Evaluates the next expression onto the stack.
+   //
+   void makeExpr(ObjectVector *objects, VariableType *type)
+   {
+      makeExpr(objects, nextExpr(type));
    }
 
    //
@@ -635,10 +728,7 @@ private:
 
          FormatData data;
 
-         // Otherwise, handle the current literal and start reading format.
-         doFormatLiteral(objects, string);
-
-         // Read flags, if any.
+         // Otherwise, read flags, if any.
          for(data.flags = 0; *c; ++c)
          {
             switch(*c)
@@ -655,7 +745,10 @@ private:
 
          // Read field width, if any.
          if(*c == '*')
+         {
             data.width = -1, ++c;
+            data.widthExpr = nextExpr(VariableType::get_bt_int());
+         }
          else for(data.width = 0; std::isdigit(*c);)
             data.width = (data.width * 10) + (*c++ - '0');
 
@@ -663,7 +756,10 @@ private:
          if(*c == '.')
          {
             if(*++c == '*')
+            {
                data.prec = -1, ++c;
+               data.precExpr = nextExpr(VariableType::get_bt_int());
+            }
             else for(data.prec = 0; std::isdigit(*c);)
                data.prec = (data.prec * 10) + (*c++ - '0');
          }
@@ -685,6 +781,10 @@ private:
          // Read conversion specifier.
          data.fmt = *c++;
 
+         // Constant arguments print as part of the literal.
+         if(doFormatConstant(data, string)) continue;
+
+         doFormatLiteral(objects, string);
          doFormat(objects, data);
       }
 
@@ -804,10 +904,197 @@ private:
 };
 
 
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static option::option_data<bool> option_opt_printf
+('\0', "opt-printf", "optimization",
+ "Formats printf, fprintf, and sprintf calls with a literal format when "
+ "compiling, rather than in vfprintf. ZDoom only. On by default.", NULL, true);
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// CountPrintfArgs
+//
+// Returns how many arguments a printf format takes, or -1 if __printf would
+// not format it the same as vfprintf.
+//
+static int CountPrintfArgs(std::string const &format)
+{
+   int count = 0;
+
+   for(char const *c = format.c_str(); *c;)
+   {
+      if(*c++ != '%') continue;
+      if(*c == '%') {++c; continue;}
+
+      // Flags.
+      while(*c && std::strchr("-+ #0", *c)) ++c;
+
+      // Field width.
+      if(*c == '*')
+         ++c, ++count;
+      else while(std::isdigit(*c)) ++c;
+
+      // Precision. vfprintf prints nothing for a zero with a precision of
+      // zero, but __printf prints the zero.
+      bool precZero = false;
+      if(*c == '.')
+      {
+         if(*++c == '*')
+            ++c, ++count, precZero = true;
+         else
+         {
+            precZero = true;
+            for(; std::isdigit(*c); ++c) if(*c != '0') precZero = false;
+         }
+      }
+
+      // Length modifier.
+      if(*c == 'h' || *c == 'l')
+      {
+         if(c[1] == *c) ++c;
+         ++c;
+      }
+      else if(*c && std::strchr("jztL", *c))
+         ++c;
+
+      // Conversion specifier.
+      switch(*c++)
+      {
+      case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+         if(precZero) return -1;
+         ++count;
+         break;
+
+      case 'c': case 's':
+         ++count;
+         break;
+
+      default:
+         return -1;
+      }
+   }
+
+   return count;
+}
+
+//
+// CreatePrintfCall
+//
+// Calls one of the printf helpers in the library by name. The helper is
+// declared as an extern, so that the linker can find it in an archive.
+//
+static SourceExpression::Pointer CreatePrintfCall(std::string const &name,
+   VariableType::Vector const &types, SourceExpression::Vector const &args,
+   SourceContext *context, SourcePosition const &pos)
+{
+   VariableType::Reference type =
+      VariableType::get_bt_fun(types, VariableType::get_bt_int());
+
+   std::string nameObj = '_' + name;
+   bigsint argCount = 0;
+
+   for(auto const &t : types)
+      argCount += t->getSize(pos);
+
+   ObjectData::Function::Add(nameObj, nameObj + "::$label", argCount,
+      type->getReturn()->getSize(pos), nullptr, LINKAGE_C);
+
+   SourceFunction::Reference func = SourceFunction::FindFunction(
+      SourceVariable::create_constant(name, type, nameObj, pos));
+
+   return SourceExpression::create_branch_call(
+      SourceExpression::create_value_function(func, context, pos), args,
+      context, pos);
+}
+
+
 //----------------------------------------------------------------------------|
 // Global Functions                                                           |
 //
 
+//
+// SourceExpression::create_branch_printf
+//
+// Rewrites a call to printf, fprintf, or sprintf with a literal format into a
+// __printf to a string, which is then written by a library helper. Returns
+// null if the call is left to vfprintf.
+//
+SRCEXP_EXPRBRA_DEFN(a, printf)
+{
+   if(!option_opt_printf.data || Target != TARGET_ZDoom || !expr->canGetFunction())
+      return NULL;
+
+   SourceFunction::Reference func = expr->getFunction();
+   std::string const &nameObj = func->var->getNameObject();
+   VariableType::Vector const &types = func->var->getType()->getTypes();
+   std::size_t formatArg;
+
+   if(nameObj == "_printf")
+      formatArg = 0;
+   else if(nameObj == "_fprintf" || nameObj == "_sprintf")
+      formatArg = 1;
+   else
+      return NULL;
+
+   if(args.size() <= formatArg || types.size() <= formatArg)
+      return NULL;
+
+   // The format must be a string literal.
+   SourceExpression *formatExpr = args[formatArg];
+
+   if(formatExpr->getType()->getBasicType() != VariableType::BT_STR ||
+      !formatExpr->canMakeObject())
+      return NULL;
+
+   ObjectExpression::Pointer formatObj = formatExpr->makeObject();
+
+   if(!formatObj->canResolveSymbol()) return NULL;
+
+   ObjectData::String const *formatData =
+      ObjectData::String::Find(formatObj->resolveSymbol());
+
+   if(!formatData) return NULL;
+
+   std::string format = formatData->string;
+
+   int count = CountPrintfArgs(format);
+   if(count < 0 || static_cast<std::size_t>(count) != args.size() - formatArg - 1)
+      return NULL;
+
+   // A line can be printed without going through the stream's buffer.
+   bool line = !format.empty() && format[format.size() - 1] == '\n';
+
+   // __printf drops one trailing newline, which sprintf has to keep.
+   if(line && nameObj == "_sprintf") format += '\n';
+
+   Vector printfArgs(args.begin() + formatArg + 1, args.end());
+   Vector callArgs(args.begin(), args.begin() + formatArg);
+   VariableType::Vector callTypes(types.begin(), types.begin() + formatArg);
+
+   callArgs.push_back(create_root_printf("__printf_string", format, printfArgs,
+                                         context, pos));
+   callTypes.push_back(VariableType::get_bt_str());
+
+   std::string name;
+
+   if(nameObj == "_printf")
+      name = line ? "_Printf_ln" : "_Printf_str";
+   else if(nameObj == "_fprintf")
+      name = line ? "_Fprintf_ln" : "_Fprintf_str";
+   else
+      name = "_Sprintf_str";
+
+   return CreatePrintfCall(name, callTypes, callArgs, context, pos);
+}
+
+
 //
 // SourceExpression::create_root_printf
 //
@@ -183,11 +183,13 @@ public:
    //
    struct FunctionAttributes
    {
+      typedef ObjectData::InlineType InlineType;
       typedef ObjectData::ScriptType ScriptType;
 
       FunctionAttributes()
        : scriptAddr(-1), scriptFlag(0), scriptType(ObjectData::ST_CLOSED),
-         asmfun(false), lnspec(false), native(false), script(false)
+         inlineType(ObjectData::IL_DEFAULT), asmfun(false), lnspec(false),
+         native(false), script(false)
       {
       }
 
@@ -196,6 +198,7 @@ public:
       bigsint       scriptAddr;
       bigsint       scriptFlag;
       ScriptType    scriptType;
+      InlineType    inlineType;
       bool          asmfun : 1;
       bool          lnspec : 1;
       bool          native : 1;
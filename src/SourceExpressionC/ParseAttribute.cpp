@@ -179,6 +179,9 @@ SourceExpressionC::FunctionAttributes SourceExpressionC::ParseFunctionAttributes
       {
          SourceTokenC::Reference tok = in->get(SourceTokenC::TT_NAM);
 
+         if(tok->data == "always_inline" || tok->data == "__always_inline" || tok->data == "__always_inline__")
+            {funcAttr.inlineType = ObjectData::IL_ALWAYS; continue;}
+
          if(tok->data == "asmfunc" || tok->data == "__asmfunc" || tok->data == "__asmfunc__")
             {ParseAttributeAsmfunc(funcAttr, in, context); continue;}
 
@@ -188,6 +191,9 @@ SourceExpressionC::FunctionAttributes SourceExpressionC::ParseFunctionAttributes
          if(tok->data == "native" || tok->data == "__native" || tok->data == "__native__")
             {ParseAttributeNative(funcAttr, in, context); continue;}
 
+         if(tok->data == "noinline" || tok->data == "__noinline" || tok->data == "__noinline__")
+            {funcAttr.inlineType = ObjectData::IL_NEVER; continue;}
+
          if(tok->data == "script" || tok->data == "__script" || tok->data == "__script__")
             {ParseAttributeScript(funcAttr, in, context); continue;}
       }
@@ -504,7 +504,13 @@ SRCEXPC_PARSE_DEFN_EXT(InitDeclarator, DeclarationSpecifiers const &spec, Declar
             decl.funcAttr.scriptType, decl.funcAttr.scriptFlag);
       }
       else
-         ObjectData::Function::Add(nameObj, label, paramSize, returnSize, nullptr, linkage);
+      {
+         if(spec.functionInline && decl.funcAttr.inlineType == ObjectData::IL_DEFAULT)
+            decl.funcAttr.inlineType = ObjectData::IL_HINT;
+
+         ObjectData::Function::Add(nameObj, label, paramSize, returnSize, nullptr,
+            linkage, decl.funcAttr.inlineType);
+      }
 
       SourceVariable::Pointer var;
       if(obj) var = SourceVariable::create_constant(decl.name, decl.type,     obj, pos);
@@ -697,8 +703,8 @@ SRCEXPC_PARSE_DEFN_EXT(Function, DeclarationSpecifiers const &spec, Declarator &
 {
    SourcePosition pos = in->peek()->pos;
 
-   if(spec.functionInline)
-      Error_P("inline not yet supported");
+   if(spec.functionInline && decl.funcAttr.inlineType == ObjectData::IL_DEFAULT)
+      decl.funcAttr.inlineType = ObjectData::IL_HINT;
 
    LinkageSpecifier linkage = spec.storage == SC_STATIC ? LINKAGE_INTERN : LINKAGE_C;
 
@@ -747,7 +753,10 @@ SRCEXPC_PARSE_DEFN_EXT(Function, DeclarationSpecifiers const &spec, Declarator &
          decl.funcAttr.scriptType, decl.funcAttr.scriptFlag);
    }
    else
-      ObjectData::Function::Add(nameObj, label, paramSize, returnSize, funcContext, linkage);
+      ObjectData::Function::Add(nameObj, label, paramSize, returnSize, funcContext,
+         linkage, decl.funcAttr.inlineType);
+
+   funcContext->setNameFunc(nameObj);
 
    SourceFunction::Reference func = SourceFunction::FindFunction(
       SourceVariable::create_constant(decl.name, decl.type, nameObj, pos));
@@ -75,6 +75,32 @@ bool option_string_func = true;
 // Static Functions                                                           |
 //
 
+//
+// is_inline_type
+//
+static bool is_inline_type(std::string const &data)
+{
+   if (data == "__inline")        return true;
+   if (data == "__always_inline") return true;
+   if (data == "__noinline")      return true;
+
+   return false;
+}
+
+//
+// make_inline_type
+//
+static ObjectData::InlineType make_inline_type(SourceTokenizerC *in)
+{
+   SourceTokenC::Reference tok = in->get(SourceTokenC::TT_NAM);
+
+   if (tok->data == "__inline")        return ObjectData::IL_HINT;
+   if (tok->data == "__always_inline") return ObjectData::IL_ALWAYS;
+   if (tok->data == "__noinline")      return ObjectData::IL_NEVER;
+
+   Error(tok->pos, "invalid inline-specifier: %s", tok->data.c_str());
+}
+
 //
 // make_func
 //
@@ -91,6 +117,13 @@ static SourceExpression::Pointer make_func
    // Don't count automatic variable args.
    if (args.store == STORE_AUTO) args.count = 0;
 
+   // inline-specifier
+   ObjectData::InlineType inlineType;
+   if (in->peekType(SourceTokenC::TT_NAM) && is_inline_type(in->peek()->data))
+      inlineType = make_inline_type(in);
+   else
+      inlineType = ObjectData::IL_DEFAULT;
+
    // Anonymous function.
    if(args.name.empty())
    {
@@ -179,7 +212,7 @@ static SourceExpression::Pointer make_func
 
    // funcAdded
    ObjectData::Function::Add(funcNameObj, funcLabel, args.count,
-      args.retn->getSize(tok->pos), args.context, linkSpec);
+      args.retn->getSize(tok->pos), args.context, linkSpec, inlineType);
 
    SourceFunction::Reference func = SourceFunction::FindFunction(funcVar, args.args);
 
@@ -191,6 +224,8 @@ static SourceExpression::Pointer make_func
       if(in->peekType(SourceTokenC::TT_SEMICOLON))
          Warn(tok->pos, "empty function definition, did you mean extern __function?");
 
+      args.context->setNameFunc(funcNameObj);
+
       func->setBody(SourceExpressionDS::make_prefix(in, args.context),
                     args.types, tok->pos);
    }
@@ -296,6 +296,8 @@ static SourceExpression::Pointer make_script
       if(in->peekType(SourceTokenC::TT_SEMICOLON))
          Warn(tok->pos, "empty script definition, did you mean extern __script?");
 
+      args.context->setNameFunc(scriptNameObj);
+
       func->setBody(SourceExpressionDS::make_prefix(in, args.context),
                     args.types, tok->pos);
    }
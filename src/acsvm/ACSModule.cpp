@@ -0,0 +1,726 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// ACS bytecode module loading.
+//
+//-----------------------------------------------------------------------------
+
+#include "ACSModule.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+
+//----------------------------------------------------------------------------|
+// Macros                                                                     |
+//
+
+//
+// CASE_CODE
+//
+#define CASE_CODE(NAME) case BinaryTokenZDACS::BCODE_##NAME
+
+//
+// CASE_AREA
+//
+// Every variable area an operator has an instruction for.
+//
+#define CASE_AREA(OP) \
+   CASE_CODE(OP##_REG):    \
+   CASE_CODE(OP##_MAPREG): \
+   CASE_CODE(OP##_WLDREG): \
+   CASE_CODE(OP##_GBLREG): \
+   CASE_CODE(OP##_MAPARR): \
+   CASE_CODE(OP##_WLDARR): \
+   CASE_CODE(OP##_GBLARR)
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// Fail
+//
+static void Fail(std::string const &filename, std::string const &msg)
+{
+   throw std::runtime_error(filename + ": " + msg);
+}
+
+//
+// GetArgCount
+//
+// Returns the number of immediate arguments of code, or -1 if the
+// instruction encodes its own count.
+//
+static int GetArgCount(ACSModule::BinaryCode code)
+{
+   switch(code)
+   {
+   CASE_AREA(ADD):
+   CASE_AREA(AND):
+   CASE_AREA(DEC):
+   CASE_AREA(DIV):
+   CASE_AREA(GET):
+   CASE_AREA(INC):
+   CASE_AREA(IOR):
+   CASE_AREA(LSH):
+   CASE_AREA(MOD):
+   CASE_AREA(MUL):
+   CASE_AREA(RSH):
+   CASE_AREA(SET):
+   CASE_AREA(SUB):
+   CASE_AREA(XOR):
+   CASE_CODE(GAME_SET_AIRCONTROL_IMM):
+   CASE_CODE(GAME_SET_GRAVITY_IMM):
+   CASE_CODE(GET_FUNCP):
+   CASE_CODE(GET_IMM):
+   CASE_CODE(GET_IMM_BYTE):
+   CASE_CODE(JMP_CAL_IMM):
+   CASE_CODE(JMP_CAL_NIL_IMM):
+   CASE_CODE(JMP_IMM):
+   CASE_CODE(JMP_NIL):
+   CASE_CODE(JMP_TRU):
+   CASE_CODE(PRINT_SET_FONT_IMM):
+   CASE_CODE(SPECIAL_EXEC1):
+   CASE_CODE(SPECIAL_EXEC2):
+   CASE_CODE(SPECIAL_EXEC3):
+   CASE_CODE(SPECIAL_EXEC4):
+   CASE_CODE(SPECIAL_EXEC5):
+   CASE_CODE(SPECIAL_EXEC5_RETN1):
+   CASE_CODE(THING_GET_INVENTORY_IMM):
+   CASE_CODE(WAIT_POLYOBJECT_IMM):
+   CASE_CODE(WAIT_SCRIPT_IMM):
+   CASE_CODE(WAIT_STAG_IMM):
+   CASE_CODE(WAIT_TICS_IMM):
+   CASE_CODE(WAIT_TICS_IMM_BYTE):
+      return 1;
+
+   CASE_CODE(GAME_GET_THINGCOUNT_SID_IMM):
+   CASE_CODE(GET_IMM_2BYTES):
+   CASE_CODE(JMP_VAL):
+   CASE_CODE(MISC_RANDOM_IMM):
+   CASE_CODE(MISC_RANDOM_IMM_BYTE):
+   CASE_CODE(NATIVE):
+   CASE_CODE(SPECIAL_EXEC1_IMM):
+   CASE_CODE(SPECIAL_EXEC1_IMM_BYTE):
+   CASE_CODE(STAG_SET_TEXTURE_CEILING_IMM):
+   CASE_CODE(STAG_SET_TEXTURE_FLOOR_IMM):
+   CASE_CODE(THING_ADD_INVENTORY_IMM):
+   CASE_CODE(THING_SUB_INVENTORY_IMM):
+      return 2;
+
+   CASE_CODE(GAME_EXEC_IMM):
+   CASE_CODE(GAME_SET_MUSIC_IMM):
+   CASE_CODE(GAME_SET_MUSICLOCAL_IMM):
+   CASE_CODE(GET_IMM_3BYTES):
+   CASE_CODE(SPECIAL_EXEC2_IMM):
+   CASE_CODE(SPECIAL_EXEC2_IMM_BYTE):
+      return 3;
+
+   CASE_CODE(GET_IMM_4BYTES):
+   CASE_CODE(SPAWN_SPOT_ANGLE_IMM):
+   CASE_CODE(SPECIAL_EXEC3_IMM):
+   CASE_CODE(SPECIAL_EXEC3_IMM_BYTE):
+      return 4;
+
+   CASE_CODE(GET_IMM_5BYTES):
+   CASE_CODE(SPECIAL_EXEC4_IMM):
+   CASE_CODE(SPECIAL_EXEC4_IMM_BYTE):
+      return 5;
+
+   CASE_CODE(SPAWN_POINT_IMM):
+   CASE_CODE(SPECIAL_EXEC5_IMM):
+   CASE_CODE(SPECIAL_EXEC5_IMM_BYTE):
+      return 6;
+
+   CASE_CODE(GET_IMM_BYTES):
+   CASE_CODE(JMP_TAB):
+      return -1;
+
+   default:
+      return 0;
+   }
+}
+
+//
+// GetArgSize
+//
+// Returns the size in bytes of an argument in the compressed format.
+//
+static std::size_t GetArgSize(ACSModule::BinaryCode code, std::size_t index)
+{
+   switch(code)
+   {
+   CASE_AREA(ADD):
+   CASE_AREA(AND):
+   CASE_AREA(DEC):
+   CASE_AREA(DIV):
+   CASE_AREA(GET):
+   CASE_AREA(INC):
+   CASE_AREA(IOR):
+   CASE_AREA(LSH):
+   CASE_AREA(MOD):
+   CASE_AREA(MUL):
+   CASE_AREA(RSH):
+   CASE_AREA(SET):
+   CASE_AREA(SUB):
+   CASE_AREA(XOR):
+   CASE_CODE(GET_FUNCP):
+   CASE_CODE(GET_IMM_BYTE):
+   CASE_CODE(GET_IMM_2BYTES):
+   CASE_CODE(GET_IMM_3BYTES):
+   CASE_CODE(GET_IMM_4BYTES):
+   CASE_CODE(GET_IMM_5BYTES):
+   CASE_CODE(JMP_CAL_IMM):
+   CASE_CODE(JMP_CAL_NIL_IMM):
+   CASE_CODE(MISC_RANDOM_IMM_BYTE):
+   CASE_CODE(SPECIAL_EXEC1_IMM_BYTE):
+   CASE_CODE(SPECIAL_EXEC2_IMM_BYTE):
+   CASE_CODE(SPECIAL_EXEC3_IMM_BYTE):
+   CASE_CODE(SPECIAL_EXEC4_IMM_BYTE):
+   CASE_CODE(SPECIAL_EXEC5_IMM_BYTE):
+   CASE_CODE(WAIT_TICS_IMM_BYTE):
+      return 1;
+
+   CASE_CODE(SPECIAL_EXEC1):
+   CASE_CODE(SPECIAL_EXEC2):
+   CASE_CODE(SPECIAL_EXEC3):
+   CASE_CODE(SPECIAL_EXEC4):
+   CASE_CODE(SPECIAL_EXEC5):
+   CASE_CODE(SPECIAL_EXEC1_IMM):
+   CASE_CODE(SPECIAL_EXEC2_IMM):
+   CASE_CODE(SPECIAL_EXEC3_IMM):
+   CASE_CODE(SPECIAL_EXEC4_IMM):
+   CASE_CODE(SPECIAL_EXEC5_IMM):
+   CASE_CODE(SPECIAL_EXEC5_RETN1):
+      return index ? 4 : 1;
+
+   CASE_CODE(NATIVE):
+      return index ? 2 : 1;
+
+   default:
+      return 4;
+   }
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// ACSModule::ACSModule
+//
+ACSModule::ACSModule(std::string const &_filename) : filename(_filename),
+   format('\0')
+{
+   std::ifstream in(filename.c_str(), std::ios_base::in|std::ios_base::binary);
+
+   if(!in) Fail(filename, "could not open");
+
+   std::ostringstream oss;
+   oss << in.rdbuf();
+   data = oss.str();
+
+   if(data.size() < 8 || data.compare(0, 3, "ACS"))
+      Fail(filename, "not an ACS lump");
+
+   registers.assign(128, 0);
+
+   std::size_t dir = getU32(4);
+
+   if(dir < 8 || dir > data.size())
+      Fail(filename, "bad directory offset");
+
+   if(data[3] == '\0')
+   {
+      // ACSE with an ACS0 header puts the real header just before the
+      // directory.
+      if(dir >= 16 && data[dir - 4] == 'A' && data[dir - 3] == 'C' &&
+         data[dir - 2] == 'S' && (data[dir - 1] == 'E' || data[dir - 1] == 'e'))
+      {
+         format = data[dir - 1];
+
+         std::size_t end = getU32(dir - 8);
+         decode(end);
+         loadACSE(end, dir - 8, true);
+      }
+      else
+      {
+         decode(dir);
+         loadACS0(dir);
+      }
+   }
+   else if(data[3] == 'E' || data[3] == 'e')
+   {
+      format = data[3];
+
+      decode(dir);
+      loadACSE(dir, data.size(), false);
+   }
+   else
+      Fail(filename, "unknown ACS format");
+
+   for(auto &function : functions)
+   {
+      if(function.addr) function.index = findAddr(function.addr);
+   }
+
+   for(auto &script : scripts)
+      script.index = findAddr(script.addr);
+}
+
+//
+// ACSModule::decode
+//
+void ACSModule::decode(std::size_t end)
+{
+   std::vector<std::size_t> argIndex;
+
+   if(end > data.size()) Fail(filename, "bad code size");
+
+   addrIndex.assign(end + 1, -1);
+
+   for(std::size_t pos = 8; pos < end;)
+   {
+      Instruction instr;
+      instr.addr = pos;
+
+      addrIndex[pos] = code.size();
+
+      // Opcode.
+      std::uint32_t op;
+      if(format == 'e')
+      {
+         op = getU8(pos++);
+         if(op >= 240) op = 240 + ((op - 240) << 8) + getU8(pos++);
+      }
+      else
+      {
+         op = getU32(pos);
+         pos += 4;
+      }
+
+      if(op >= BinaryTokenZDACS::BCODE_NONE)
+      {
+         std::ostringstream oss;
+         oss << "unknown instruction " << op << " at " << instr.addr;
+         Fail(filename, oss.str());
+      }
+
+      instr.code = static_cast<BinaryCode>(op);
+
+      argIndex.push_back(argData.size());
+
+      // Arguments.
+      int argc = GetArgCount(instr.code);
+
+      if(instr.code == BinaryTokenZDACS::BCODE_JMP_TAB)
+      {
+         pos = (pos + 3) & ~std::size_t(3);
+         argc = getU32(pos) * 2;
+         pos += 4;
+
+         for(int i = 0; i != argc; ++i, pos += 4)
+            argData.push_back(getS32(pos));
+      }
+      else if(instr.code == BinaryTokenZDACS::BCODE_GET_IMM_BYTES)
+      {
+         argc = getU8(pos++);
+
+         for(int i = 0; i != argc; ++i)
+            argData.push_back(getU8(pos++));
+      }
+      else for(int i = 0; i != argc; ++i)
+      {
+         switch(format == 'e' ? GetArgSize(instr.code, i) : 4)
+         {
+         case 1: argData.push_back(getU8(pos));  pos += 1; break;
+         case 2: argData.push_back(getU16(pos)); pos += 2; break;
+         default: argData.push_back(getS32(pos)); pos += 4; break;
+         }
+      }
+
+      instr.argc = argc;
+      instr.args = NULL;
+
+      code.push_back(instr);
+   }
+
+   for(std::size_t i = 0, e = code.size(); i != e; ++i)
+      code[i].args = argData.data() + argIndex[i];
+}
+
+//
+// ACSModule::findAddr
+//
+std::size_t ACSModule::findAddr(std::uint32_t addr) const
+{
+   if(addr >= addrIndex.size() || addrIndex[addr] < 0)
+   {
+      std::ostringstream oss;
+      oss << "no instruction at " << addr;
+      Fail(filename, oss.str());
+   }
+
+   return addrIndex[addr];
+}
+
+//
+// ACSModule::findScript
+//
+ACSModule::Script const *ACSModule::findScript(std::int32_t number) const
+{
+   for(auto const &script : scripts)
+      if(script.number == number) return &script;
+
+   return NULL;
+}
+
+//
+// ACSModule::findScript
+//
+ACSModule::Script const *ACSModule::findScript(std::string const &name) const
+{
+   for(auto const &script : scripts)
+      if(!script.name.empty() && script.name == name) return &script;
+
+   return NULL;
+}
+
+//
+// ACSModule::getS32
+//
+std::int32_t ACSModule::getS32(std::size_t pos) const
+{
+   return static_cast<std::int32_t>(getU32(pos));
+}
+
+//
+// ACSModule::getString
+//
+std::string ACSModule::getString(std::size_t pos) const
+{
+   if(pos >= data.size()) Fail(filename, "bad string offset");
+
+   return std::string(data.c_str() + pos);
+}
+
+//
+// ACSModule::getU16
+//
+std::uint32_t ACSModule::getU16(std::size_t pos) const
+{
+   return getU8(pos) | (getU8(pos + 1) << 8);
+}
+
+//
+// ACSModule::getU32
+//
+std::uint32_t ACSModule::getU32(std::size_t pos) const
+{
+   return getU16(pos) | (getU16(pos + 2) << 16);
+}
+
+//
+// ACSModule::getU8
+//
+std::uint32_t ACSModule::getU8(std::size_t pos) const
+{
+   if(pos >= data.size()) Fail(filename, "truncated");
+
+   return static_cast<unsigned char>(data[pos]);
+}
+
+//
+// ACSModule::GetScriptType
+//
+char const *ACSModule::GetScriptType(int type)
+{
+   switch(type)
+   {
+   case  0: return "closed";
+   case  1: return "open";
+   case  2: return "respawn";
+   case  3: return "death";
+   case  4: return "enter";
+   case  5: return "pickup";
+   case  6: return "bluereturn";
+   case  7: return "redreturn";
+   case  8: return "whitereturn";
+   case 12: return "lightning";
+   case 13: return "unloading";
+   case 14: return "disconnect";
+   case 15: return "return";
+   case 16: return "event";
+   case 17: return "kill";
+   case 18: return "reopen";
+   default: return "unknown";
+   }
+}
+
+//
+// ACSModule::loadACS0
+//
+void ACSModule::loadACS0(std::size_t dir)
+{
+   std::size_t pos = dir;
+
+   std::uint32_t count = getU32(pos);
+   pos += 4;
+
+   for(std::uint32_t i = 0; i != count; ++i, pos += 12)
+   {
+      Script script;
+      std::uint32_t number = getU32(pos);
+
+      script.number   = number % 1000;
+      script.type     = number / 1000;
+      script.addr     = getU32(pos + 4);
+      script.argCount = getU32(pos + 8);
+      script.varCount = 20;
+      script.index    = 0;
+
+      scripts.push_back(script);
+   }
+
+   count = getU32(pos);
+   pos += 4;
+
+   for(std::uint32_t i = 0; i != count; ++i, pos += 4)
+      strings.push_back(getString(getU32(pos)));
+}
+
+//
+// ACSModule::loadACSE
+//
+// Chunks can refer to each other, so they are loaded in a fixed order
+// instead of the order they appear in.
+//
+void ACSModule::loadACSE(std::size_t begin, std::size_t end, bool fake)
+{
+   static char const *const order[] =
+   {
+      "ARAY", "FUNC", "SPTR", "STRL", "JUMP", "LOAD", "MINI", "AINI", "FNAM",
+      "SNAM", "SVCT",
+   };
+
+   std::vector<std::size_t> chunks;
+
+   while(begin + 8 <= end)
+   {
+      std::size_t size = getU32(begin + 4);
+
+      if(size > end - begin - 8)
+         Fail(filename, "truncated " + data.substr(begin, 4));
+
+      chunks.push_back(begin);
+      begin += 8 + size;
+   }
+
+   for(char const *name : order)
+   {
+      for(std::size_t chunk : chunks)
+      {
+         if(!data.compare(chunk, 4, name))
+            loadChunk(name, chunk + 8, chunk + 8 + getU32(chunk + 4), fake);
+      }
+   }
+
+   // Map arrays are found through the register with their number.
+   for(std::size_t i = 0, e = arrays.size(); i != e; ++i)
+      registers[arrays[i].number] = i;
+}
+
+//
+// ACSModule::loadChunk
+//
+void ACSModule::loadChunk(char const *name, std::size_t begin, std::size_t end,
+   bool fake)
+{
+   std::string const chunk = name;
+
+   if(chunk == "AINI")
+   {
+      std::int32_t number = getS32(begin);
+
+      for(auto &array : arrays)
+      {
+         if(array.number != number) continue;
+
+         for(std::size_t i = 0, pos = begin + 4; i != array.data.size() &&
+             pos < end; ++i, pos += 4)
+            array.data[i] = getS32(pos);
+      }
+   }
+   else if(chunk == "ARAY")
+   {
+      for(; begin + 8 <= end; begin += 8)
+      {
+         Array array;
+         array.number = getS32(begin);
+         array.data.assign(getU32(begin + 4), 0);
+
+         if(array.number < 0 || array.number > 0xFFFF)
+            Fail(filename, "bad array number");
+
+         if(static_cast<std::size_t>(array.number) >= registers.size())
+            registers.resize(array.number + 1, 0);
+
+         arrays.push_back(array);
+      }
+   }
+   else if(chunk == "FNAM")
+   {
+      std::vector<std::string> names;
+
+      readStringTable(begin, end, false, &names);
+
+      for(std::size_t i = 0, e = names.size(); i != e && i != functions.size(); ++i)
+         functions[i].name = names[i];
+   }
+   else if(chunk == "FUNC")
+   {
+      for(; begin + 8 <= end; begin += 8)
+      {
+         Function function;
+         function.argCount = getU8(begin + 0);
+         function.varCount = getU8(begin + 1);
+         function.retn     = getU8(begin + 2);
+         function.addr     = getU32(begin + 4);
+         function.index    = 0;
+
+         functions.push_back(function);
+      }
+   }
+   else if(chunk == "JUMP")
+   {
+      for(; begin + 4 <= end; begin += 4)
+         jumps.push_back(getU32(begin));
+   }
+   else if(chunk == "LOAD")
+   {
+      for(std::size_t pos = begin; pos < end;)
+      {
+         std::string lib = getString(pos);
+         pos += lib.size() + 1;
+
+         if(!lib.empty()) libraries.push_back(lib);
+      }
+   }
+   else if(chunk == "MINI")
+   {
+      std::size_t number = getU32(begin);
+
+      for(std::size_t pos = begin + 4; pos + 4 <= end; pos += 4, ++number)
+      {
+         if(number >= registers.size()) registers.resize(number + 1, 0);
+
+         registers[number] = getS32(pos);
+      }
+   }
+   else if(chunk == "SNAM")
+   {
+      std::vector<std::string> names;
+
+      readStringTable(begin, end, false, &names);
+
+      for(auto &script : scripts)
+      {
+         std::size_t i = -1 - script.number;
+
+         if(script.number < 0 && i < names.size())
+            script.name = names[i];
+      }
+   }
+   else if(chunk == "SPTR")
+   {
+      std::size_t step = fake ? 8 : 12;
+
+      for(; begin + step <= end; begin += step)
+      {
+         Script script;
+
+         if(fake)
+         {
+            script.number   = static_cast<std::int16_t>(getU16(begin));
+            script.type     = getU8(begin + 2);
+            script.argCount = getU8(begin + 3);
+            script.addr     = getU32(begin + 4);
+         }
+         else
+         {
+            script.number   = static_cast<std::int16_t>(getU16(begin));
+            script.type     = getU16(begin + 2);
+            script.addr     = getU32(begin + 4);
+            script.argCount = getU32(begin + 8);
+         }
+
+         script.varCount = 20;
+         script.index    = 0;
+
+         scripts.push_back(script);
+      }
+   }
+   else if(chunk == "STRL")
+   {
+      readStringTable(begin, end, true, &strings);
+   }
+   else if(chunk == "SVCT")
+   {
+      for(; begin + 4 <= end; begin += 4)
+      {
+         std::int32_t number = static_cast<std::int16_t>(getU16(begin));
+
+         for(auto &script : scripts)
+         {
+            if(script.number == number)
+               script.varCount = getU16(begin + 2);
+         }
+      }
+   }
+}
+
+//
+// ACSModule::readStringTable
+//
+void ACSModule::readStringTable(std::size_t begin, std::size_t end, bool junk,
+   std::vector<std::string> *table) const
+{
+   if(begin == end) return;
+
+   std::size_t pos = begin + (junk ? 4 : 0);
+   std::uint32_t count = getU32(pos);
+
+   pos += junk ? 8 : 4;
+
+   for(std::uint32_t i = 0; i != count; ++i, pos += 4)
+   {
+      std::size_t offset = begin + getU32(pos);
+
+      if(offset >= end) Fail(filename, "bad string table");
+
+      table->push_back(getString(offset));
+   }
+}
+
+// EOF
+
@@ -0,0 +1,146 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// ACS bytecode modules for the reference interpreter.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef HPP_ACSModule_
+#define HPP_ACSModule_
+
+#include "../BinaryTokenZDACS.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// ACSModule
+//
+// A loaded ACS0, ACSE, or ACSe lump. The code is decoded once up front so
+// the interpreter never has to look at encoding details.
+//
+class ACSModule
+{
+public:
+   typedef BinaryTokenZDACS::BinaryCode BinaryCode;
+
+   //
+   // Instruction
+   //
+   struct Instruction
+   {
+      BinaryCode    code;
+      std::uint32_t addr;
+      std::size_t   argc;
+      std::int32_t const *args;
+   };
+
+   //
+   // Array
+   //
+   struct Array
+   {
+      std::int32_t number;
+      std::vector<std::int32_t> data;
+   };
+
+   //
+   // Function
+   //
+   struct Function
+   {
+      std::string   name;
+      std::uint32_t addr;
+      std::size_t   index;
+      int           argCount;
+      int           varCount;
+      bool          retn;
+   };
+
+   //
+   // Script
+   //
+   struct Script
+   {
+      std::string   name;
+      std::uint32_t addr;
+      std::size_t   index;
+      std::int32_t  number;
+      int           argCount;
+      int           varCount;
+      int           type;
+   };
+
+
+   explicit ACSModule(std::string const &filename);
+
+   // Returns the index of the instruction at addr. Throws if there is none.
+   std::size_t findAddr(std::uint32_t addr) const;
+
+   // Returns the script with the given number or name, or NULL.
+   Script const *findScript(std::int32_t number) const;
+   Script const *findScript(std::string const &name) const;
+
+   std::vector<Instruction> code;
+   std::vector<Array>       arrays;
+   std::vector<Function>    functions;
+   std::vector<Script>      scripts;
+   std::vector<std::string> strings;
+   std::vector<std::uint32_t> jumps;
+   std::vector<std::string> libraries;
+
+   // Map register initializers, indexed by register.
+   std::vector<std::int32_t> registers;
+
+   std::string filename;
+   char format; // '\0' for ACS0, otherwise 'E' or 'e'.
+
+
+   // Returns the name of a script type.
+   static char const *GetScriptType(int type);
+
+private:
+   void decode(std::size_t end);
+
+   void loadACS0(std::size_t dir);
+   void loadACSE(std::size_t begin, std::size_t end, bool fake);
+   void loadChunk(char const *name, std::size_t begin, std::size_t end, bool fake);
+
+   std::int32_t  getS32(std::size_t pos) const;
+   std::uint32_t getU16(std::size_t pos) const;
+   std::uint32_t getU32(std::size_t pos) const;
+   std::uint32_t getU8(std::size_t pos) const;
+   std::string   getString(std::size_t pos) const;
+
+   void readStringTable(std::size_t begin, std::size_t end, bool junk,
+                        std::vector<std::string> *table) const;
+
+   std::vector<std::int32_t> argData;
+   std::vector<std::int32_t> addrIndex;
+   std::string data;
+};
+
+#endif//HPP_ACSModule_
+
@@ -0,0 +1,1602 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Reference ACS interpreter.
+//
+//-----------------------------------------------------------------------------
+
+#include "ACSVM.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+
+//----------------------------------------------------------------------------|
+// Macros                                                                     |
+//
+
+//
+// CASE_CODE
+//
+#define CASE_CODE(NAME) case BinaryTokenZDACS::BCODE_##NAME
+
+//
+// CASE_BINARY
+//
+#define CASE_BINARY(NAME, FUNC) \
+   CASE_CODE(NAME): \
+   { \
+      std::int32_t r = Pop(stack); \
+      std::int32_t &l = Top(stack); \
+      l = FUNC(l, r); \
+   } \
+   break
+
+//
+// CASE_VAR
+//
+// Expands to an instruction for every variable area. PRE runs before the
+// element index of an array is popped, and BODY can refer to the variable
+// as var.
+//
+#define CASE_VAR(OP, PRE, BODY) \
+   CASE_CODE(OP##_REG): \
+      {PRE std::int32_t &var = getLocal(thread, in.args[0]); BODY} break; \
+   CASE_CODE(OP##_MAPREG): \
+      {PRE std::int32_t &var = getMapReg(in.args[0]); BODY} break; \
+   CASE_CODE(OP##_WLDREG): \
+      {PRE std::int32_t &var = getWorldReg(in.args[0]); BODY} break; \
+   CASE_CODE(OP##_GBLREG): \
+      {PRE std::int32_t &var = getGlobalReg(in.args[0]); BODY} break; \
+   CASE_CODE(OP##_MAPARR): \
+      {PRE std::int32_t idx = Pop(stack); \
+       std::int32_t &var = getMapArray(in.args[0], idx); BODY} break; \
+   CASE_CODE(OP##_WLDARR): \
+      {PRE std::int32_t idx = Pop(stack); \
+       std::int32_t &var = getWorldArray(in.args[0])[idx]; BODY} break; \
+   CASE_CODE(OP##_GBLARR): \
+      {PRE std::int32_t idx = Pop(stack); \
+       std::int32_t &var = getGlobalArray(in.args[0])[idx]; BODY} break
+
+//
+// CASE_VAR_BINARY
+//
+#define CASE_VAR_BINARY(OP, FUNC) \
+   CASE_VAR(OP, std::int32_t value = Pop(stack);, var = FUNC(var, value);)
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// ExecError
+//
+// An error that already says where it happened.
+//
+class ExecError : public std::runtime_error
+{
+public:
+   explicit ExecError(std::string const &msg) : std::runtime_error(msg) {}
+};
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static double const Pi = 3.14159265358979323846;
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// Add
+//
+static std::int32_t Add(std::int32_t l, std::int32_t r)
+{
+   return static_cast<std::int32_t>(static_cast<std::uint32_t>(l) + r);
+}
+
+//
+// And
+//
+static std::int32_t And(std::int32_t l, std::int32_t r)
+{
+   return l & r;
+}
+
+//
+// CmpEQ
+//
+static std::int32_t CmpEQ(std::int32_t l, std::int32_t r)
+{
+   return l == r;
+}
+
+//
+// CmpGE
+//
+static std::int32_t CmpGE(std::int32_t l, std::int32_t r)
+{
+   return l >= r;
+}
+
+//
+// CmpGT
+//
+static std::int32_t CmpGT(std::int32_t l, std::int32_t r)
+{
+   return l > r;
+}
+
+//
+// CmpLE
+//
+static std::int32_t CmpLE(std::int32_t l, std::int32_t r)
+{
+   return l <= r;
+}
+
+//
+// CmpLT
+//
+static std::int32_t CmpLT(std::int32_t l, std::int32_t r)
+{
+   return l < r;
+}
+
+//
+// CmpNE
+//
+static std::int32_t CmpNE(std::int32_t l, std::int32_t r)
+{
+   return l != r;
+}
+
+//
+// Div
+//
+static std::int32_t Div(std::int32_t l, std::int32_t r)
+{
+   if(!r) throw std::runtime_error("division by zero");
+   if(r == -1) return static_cast<std::int32_t>(0u - static_cast<std::uint32_t>(l));
+
+   return l / r;
+}
+
+//
+// DivX
+//
+static std::int32_t DivX(std::int32_t l, std::int32_t r)
+{
+   if(!r) throw std::runtime_error("division by zero");
+
+   return static_cast<std::int32_t>((static_cast<std::int64_t>(l) << 16) / r);
+}
+
+//
+// GetEngineStack
+//
+// Finds the stack effect of an instruction that only interacts with the
+// game. Returns false if code is not one of those.
+//
+static bool GetEngineStack(ACSModule::BinaryCode code, int *pop, int *push)
+{
+   switch(code)
+   {
+   CASE_CODE(GAME_EXEC_IMM):
+   CASE_CODE(GAME_SET_AIRCONTROL_IMM):
+   CASE_CODE(GAME_SET_GRAVITY_IMM):
+   CASE_CODE(GAME_SET_MUSIC_IMM):
+   CASE_CODE(GAME_SET_MUSICLOCAL_IMM):
+   CASE_CODE(LINE_CLR_SPECIAL):
+   CASE_CODE(PRINT_SET_FONT_IMM):
+   CASE_CODE(SCREEN_FADE_STOP):
+   CASE_CODE(STAG_SET_TEXTURE_CEILING_IMM):
+   CASE_CODE(STAG_SET_TEXTURE_FLOOR_IMM):
+   CASE_CODE(THING_ADD_INVENTORY_IMM):
+   CASE_CODE(THING_CLR_INVENTORY):
+   CASE_CODE(THING_SUB_INVENTORY_IMM):
+   CASE_CODE(TRANSLATION_END):
+   CASE_CODE(WAIT_POLYOBJECT_IMM):
+   CASE_CODE(WAIT_STAG_IMM):
+      *pop = 0; *push = 0; return true;
+
+   CASE_CODE(GAME_GET_INVASIONSTATE):
+   CASE_CODE(GAME_GET_INVASIONWAVE):
+   CASE_CODE(GAME_GET_PLAYERCOUNT):
+   CASE_CODE(GAME_GET_SKILL):
+   CASE_CODE(GAME_GET_TEAMINFO_PLAYERCOUNT_BLUE):
+   CASE_CODE(GAME_GET_TEAMINFO_PLAYERCOUNT_RED):
+   CASE_CODE(GAME_GET_TEAMINFO_SCORE_BLUE):
+   CASE_CODE(GAME_GET_TEAMINFO_SCORE_RED):
+   CASE_CODE(GAME_GET_THINGCOUNT_SID_IMM):
+   CASE_CODE(GAME_GET_TYPE):
+   CASE_CODE(GAME_GET_TYPE_ONEFLAGCTF):
+   CASE_CODE(GAME_GET_TYPE_SINGLEPLAYER):
+   CASE_CODE(LINE_GET_OFFSETY):
+   CASE_CODE(LINE_GET_SIDE):
+   CASE_CODE(SCREEN_GET_HEIGHT):
+   CASE_CODE(SCREEN_GET_WIDTH):
+   CASE_CODE(SPAWN_POINT_IMM):
+   CASE_CODE(SPAWN_SPOT_ANGLE_IMM):
+   CASE_CODE(THING_GET_ARMOR):
+   CASE_CODE(THING_GET_FRAGS):
+   CASE_CODE(THING_GET_HEALTH):
+   CASE_CODE(THING_GET_INVENTORY_IMM):
+   CASE_CODE(THING_GET_MTAG):
+   CASE_CODE(THING_GET_PLAYERNUMBER):
+   CASE_CODE(THING_GET_SIGIL):
+   CASE_CODE(THING_GET_TEAM):
+      *pop = 0; *push = 1; return true;
+
+   CASE_CODE(GAME_SET_AIRCONTROL):
+   CASE_CODE(GAME_SET_GRAVITY):
+   CASE_CODE(MTAG_CLR_INVENTORY):
+   CASE_CODE(PRINT_SET_FONT):
+   CASE_CODE(SOUND_SEQUENCE):
+   CASE_CODE(THING_SET_MUGSHOT):
+   CASE_CODE(TRANSLATION_START):
+   CASE_CODE(WAIT_POLYOBJECT):
+   CASE_CODE(WAIT_STAG):
+      *pop = 1; *push = 0; return true;
+
+   CASE_CODE(GAME_GET_CVAR):
+   CASE_CODE(GAME_GET_LEVELINFO):
+   CASE_CODE(MISC_PLAYMOVIE):
+   CASE_CODE(MTAG_GET_ANGLE):
+   CASE_CODE(MTAG_GET_CEILINGZ):
+   CASE_CODE(MTAG_GET_CLASSIFICATION):
+   CASE_CODE(MTAG_GET_FLOORZ):
+   CASE_CODE(MTAG_GET_LIGHTLEVEL):
+   CASE_CODE(MTAG_GET_PITCH):
+   CASE_CODE(MTAG_GET_X):
+   CASE_CODE(MTAG_GET_Y):
+   CASE_CODE(MTAG_GET_Z):
+   CASE_CODE(PLAYER_GET_CAMERA):
+   CASE_CODE(PLAYER_GET_CLASS):
+   CASE_CODE(PLAYER_GET_INGAME):
+   CASE_CODE(PLAYER_GET_ISBOT):
+   CASE_CODE(STAG_GET_LIGHTLEVEL):
+   CASE_CODE(THING_CHK_WEAPON):
+   CASE_CODE(THING_GET_AMMOCAP):
+   CASE_CODE(THING_GET_INVENTORY):
+   CASE_CODE(THING_SET_WEAPON):
+   CASE_CODE(THING_USEINVENTORY):
+      *pop = 1; *push = 1; return true;
+
+   CASE_CODE(GAME_SET_MUSICST):
+   CASE_CODE(GAME_SET_SKY):
+   CASE_CODE(LTAG_SET_BLOCK):
+   CASE_CODE(LTAG_SET_BLOCKMONSTER):
+   CASE_CODE(MTAG_SET_ANGLE):
+   CASE_CODE(MTAG_SET_MARINESPRITE):
+   CASE_CODE(MTAG_SET_MARINEWEAPON):
+   CASE_CODE(MTAG_SET_PITCH):
+   CASE_CODE(SOUND_AMBIENT):
+   CASE_CODE(SOUND_AMBIENTLOCAL):
+   CASE_CODE(SOUND_SECTOR):
+   CASE_CODE(SOUND_THING):
+   CASE_CODE(STAG_SET_TEXTURE_CEILING):
+   CASE_CODE(STAG_SET_TEXTURE_FLOOR):
+   CASE_CODE(THING_ADD_INVENTORY):
+   CASE_CODE(THING_SET_AMMOCAP):
+   CASE_CODE(THING_SUB_INVENTORY):
+      *pop = 2; *push = 0; return true;
+
+   CASE_CODE(GAME_GET_THINGCOUNT_SID):
+   CASE_CODE(GAME_GET_THINGCOUNT_STR):
+   CASE_CODE(MTAG_CHK_TEXTURE_CEILING):
+   CASE_CODE(MTAG_CHK_TEXTURE_FLOOR):
+   CASE_CODE(MTAG_GET):
+   CASE_CODE(MTAG_GET_INVENTORY):
+   CASE_CODE(MTAG_UNMORPH):
+   CASE_CODE(MTAG_USEINVENTORY):
+   CASE_CODE(PLAYER_GET_INFO):
+   CASE_CODE(PLAYER_GET_INPUT):
+      *pop = 2; *push = 1; return true;
+
+   CASE_CODE(GAME_EXEC):
+   CASE_CODE(GAME_REPLACETEXTURES):
+   CASE_CODE(GAME_SET_MUSIC):
+   CASE_CODE(GAME_SET_MUSICLOCAL):
+   CASE_CODE(MTAG_ADD_INVENTORY):
+   CASE_CODE(MTAG_SET):
+   CASE_CODE(MTAG_SET_CAMERATEXTURE):
+   CASE_CODE(MTAG_SUB_INVENTORY):
+   CASE_CODE(SCREEN_SET_HUDSIZE):
+   CASE_CODE(SOUND_MTAG):
+      *pop = 3; *push = 0; return true;
+
+   CASE_CODE(MTAG_DAMAGE):
+   CASE_CODE(MTAG_SET_STATE):
+   CASE_CODE(SPAWN_SPOT):
+   CASE_CODE(STAG_GET_THINGCOUNT_SID):
+   CASE_CODE(STAG_GET_THINGCOUNT_STR):
+   CASE_CODE(STAG_GET_Z_CEILING):
+   CASE_CODE(STAG_GET_Z_FLOOR):
+      *pop = 3; *push = 1; return true;
+
+   CASE_CODE(GAME_SET_LEVEL):
+   CASE_CODE(LTAG_SET_TEXTURE):
+   CASE_CODE(TRANSLATION_PALETTE):
+      *pop = 4; *push = 0; return true;
+
+   CASE_CODE(SPAWN_SPOT_ANGLE):
+      *pop = 4; *push = 1; return true;
+
+   CASE_CODE(SCREEN_FADE_START):
+   CASE_CODE(STAG_DAMAGE):
+      *pop = 5; *push = 0; return true;
+
+   CASE_CODE(MTAG_SET_XYZ):
+      *pop = 5; *push = 1; return true;
+
+   CASE_CODE(SPAWN_POINT):
+      *pop = 6; *push = 1; return true;
+
+   CASE_CODE(LTAG_SET_SPECIAL):
+   CASE_CODE(MTAG_SET_SPECIAL):
+   CASE_CODE(SPAWN_PROJECTILE_SID):
+   CASE_CODE(SPAWN_PROJECTILE_STR):
+      *pop = 7; *push = 0; return true;
+
+   CASE_CODE(MTAG_MORPH):
+      *pop = 7; *push = 1; return true;
+
+   CASE_CODE(STAG_SET_TRIGGER_CEILING):
+   CASE_CODE(STAG_SET_TRIGGER_FLOOR):
+   CASE_CODE(TRANSLATION_DESAT):
+   CASE_CODE(TRANSLATION_RGB):
+      *pop = 8; *push = 0; return true;
+
+   CASE_CODE(SCREEN_FADE_RANGE):
+      *pop = 9; *push = 0; return true;
+
+   default:
+      return false;
+   }
+}
+
+//
+// Ior
+//
+static std::int32_t Ior(std::int32_t l, std::int32_t r)
+{
+   return l | r;
+}
+
+//
+// LogAnd
+//
+static std::int32_t LogAnd(std::int32_t l, std::int32_t r)
+{
+   return l && r;
+}
+
+//
+// LogIor
+//
+static std::int32_t LogIor(std::int32_t l, std::int32_t r)
+{
+   return l || r;
+}
+
+//
+// Lsh
+//
+static std::int32_t Lsh(std::int32_t l, std::int32_t r)
+{
+   return static_cast<std::int32_t>(static_cast<std::uint32_t>(l) << (r & 31));
+}
+
+//
+// Mod
+//
+static std::int32_t Mod(std::int32_t l, std::int32_t r)
+{
+   if(!r) throw std::runtime_error("division by zero");
+   if(r == -1) return 0;
+
+   return l % r;
+}
+
+//
+// Mul
+//
+static std::int32_t Mul(std::int32_t l, std::int32_t r)
+{
+   return static_cast<std::int32_t>(static_cast<std::uint32_t>(l) *
+                                    static_cast<std::uint32_t>(r));
+}
+
+//
+// MulX
+//
+static std::int32_t MulX(std::int32_t l, std::int32_t r)
+{
+   return static_cast<std::int32_t>((static_cast<std::int64_t>(l) * r) >> 16);
+}
+
+//
+// Pop
+//
+static std::int32_t Pop(std::vector<std::int32_t> &stack)
+{
+   if(stack.empty()) throw std::runtime_error("stack underflow");
+
+   std::int32_t value = stack.back();
+   stack.pop_back();
+   return value;
+}
+
+//
+// Rsh
+//
+static std::int32_t Rsh(std::int32_t l, std::int32_t r)
+{
+   return l >> (r & 31);
+}
+
+//
+// Sub
+//
+static std::int32_t Sub(std::int32_t l, std::int32_t r)
+{
+   return static_cast<std::int32_t>(static_cast<std::uint32_t>(l) - r);
+}
+
+//
+// Top
+//
+static std::int32_t &Top(std::vector<std::int32_t> &stack)
+{
+   if(stack.empty()) throw std::runtime_error("stack underflow");
+
+   return stack.back();
+}
+
+//
+// Xor
+//
+static std::int32_t Xor(std::int32_t l, std::int32_t r)
+{
+   return l ^ r;
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// ACSVM::SparseArray::operator []
+//
+std::int32_t &ACSVM::SparseArray::operator [] (std::int32_t index)
+{
+   // Code generally uses these arrays from 0 up, so that part is direct.
+   if(index >= 0 && index < 0x1000000)
+   {
+      if(static_cast<std::size_t>(index) >= low.size())
+         low.resize(std::max<std::size_t>(index + 1, low.size() * 2), 0);
+
+      return low[index];
+   }
+
+   return high[index];
+}
+
+//
+// ACSVM::ACSVM
+//
+ACSVM::ACSVM(ACSModule const &_module) :
+   functionCounts(_module.functions.size()),
+   scriptCounts(_module.scripts.size()),
+   codeCounts(BinaryTokenZDACS::BCODE_NONE, 0),
+   instructions(0), tics(0), limitInstructions(0), limitTics(0), seed(0),
+   out(NULL), module(_module), mapRegs(_module.registers),
+   worldRegs(256, 0), globalRegs(64, 0), worldArrays(256), globalArrays(64),
+   strings(_module.strings), scratch(0)
+{
+   for(auto const &array : module.arrays)
+      mapArrays.push_back(array.data);
+}
+
+//
+// ACSVM::call
+//
+void ACSVM::call(Thread *thread, std::size_t index, bool discard)
+{
+   if(index >= module.functions.size() || !module.functions[index].addr)
+      throw std::runtime_error("call to undefined function");
+
+   ACSModule::Function const &func = module.functions[index];
+
+   CallFrame frame;
+   frame.counter   = thread->counter;
+   frame.ip        = thread->ip;
+   frame.localBase = thread->localBase;
+   frame.discard   = discard;
+   thread->calls.push_back(frame);
+
+   std::size_t base = thread->locals.size();
+   std::size_t count = std::max(func.varCount, func.argCount);
+
+   thread->locals.resize(base + count, 0);
+
+   for(std::size_t i = func.argCount; i--;)
+      thread->locals[base + i] = Pop(thread->stack);
+
+   thread->localBase = base;
+   thread->ip        = func.index;
+   thread->counter   = &functionCounts[index];
+
+   ++thread->counter->calls;
+}
+
+//
+// ACSVM::exec
+//
+void ACSVM::exec(Thread *thread)
+{
+   try
+   {
+      execCode(thread);
+   }
+   catch(ExecError const &)
+   {
+      throw;
+   }
+   catch(std::runtime_error const &e)
+   {
+      std::ostringstream oss;
+
+      oss << "script ";
+      if(thread->script->name.empty())
+         oss << thread->script->number;
+      else
+         oss << '"' << thread->script->name << '"';
+
+      if(!thread->calls.empty())
+      {
+         std::size_t func = thread->counter - functionCounts.data();
+         std::string const &name = module.functions[func].name;
+
+         oss << ", function " << (name.empty() ? "?" : name);
+      }
+
+      if(thread->ip && thread->ip <= module.code.size())
+         oss << ", at " << module.code[thread->ip - 1].addr;
+
+      oss << ": " << e.what();
+
+      throw ExecError(oss.str());
+   }
+}
+
+//
+// ACSVM::execCode
+//
+void ACSVM::execCode(Thread *thread)
+{
+   std::vector<std::int32_t> &stack = thread->stack;
+   std::size_t const codeSize = module.code.size();
+
+   while(thread->state == TS_RUNNING)
+   {
+      if(thread->ip >= codeSize)
+         throw std::runtime_error("ran off the end of the code");
+
+      ACSModule::Instruction const &in = module.code[thread->ip++];
+
+      ++thread->counter->instructions;
+      ++codeCounts[in.code];
+
+      if(++instructions == limitInstructions)
+         throw std::runtime_error("instruction limit reached");
+
+      switch(in.code)
+      {
+      CASE_CODE(NOP):
+         break;
+
+      // Arithmetic.
+      CASE_BINARY(ADD_STK, Add);
+      CASE_BINARY(AND_STK, And);
+      CASE_BINARY(CMP_EQ, CmpEQ);
+      CASE_BINARY(CMP_GE, CmpGE);
+      CASE_BINARY(CMP_GT, CmpGT);
+      CASE_BINARY(CMP_LE, CmpLE);
+      CASE_BINARY(CMP_LT, CmpLT);
+      CASE_BINARY(CMP_NE, CmpNE);
+      CASE_BINARY(DIV_STK, Div);
+      CASE_BINARY(DIV_STK_X, DivX);
+      CASE_BINARY(IOR_STK, Ior);
+      CASE_BINARY(LOGAND_STK, LogAnd);
+      CASE_BINARY(LOGIOR_STK, LogIor);
+      CASE_BINARY(LSH_STK, Lsh);
+      CASE_BINARY(MOD_STK, Mod);
+      CASE_BINARY(MUL_STK, Mul);
+      CASE_BINARY(MUL_STK_X, MulX);
+      CASE_BINARY(RSH_STK, Rsh);
+      CASE_BINARY(SUB_STK, Sub);
+      CASE_BINARY(XOR_STK, Xor);
+
+      CASE_CODE(INV_STK): Top(stack) = ~Top(stack); break;
+      CASE_CODE(NEG_STK): Top(stack) = Sub(0, Top(stack)); break;
+      CASE_CODE(NOT_STK): Top(stack) = !Top(stack); break;
+
+      // Variables.
+      CASE_VAR_BINARY(ADD, Add);
+      CASE_VAR_BINARY(AND, And);
+      CASE_VAR_BINARY(DIV, Div);
+      CASE_VAR_BINARY(IOR, Ior);
+      CASE_VAR_BINARY(LSH, Lsh);
+      CASE_VAR_BINARY(MOD, Mod);
+      CASE_VAR_BINARY(MUL, Mul);
+      CASE_VAR_BINARY(RSH, Rsh);
+      CASE_VAR_BINARY(SUB, Sub);
+      CASE_VAR_BINARY(XOR, Xor);
+
+      CASE_VAR(DEC, , var = Sub(var, 1););
+      CASE_VAR(GET, , stack.push_back(var););
+      CASE_VAR(INC, , var = Add(var, 1););
+      CASE_VAR(SET, std::int32_t value = Pop(stack);, var = value;);
+
+      // Stack.
+      CASE_CODE(GET_FUNCP):
+      CASE_CODE(GET_IMM):
+      CASE_CODE(GET_IMM_BYTE):
+      CASE_CODE(GET_IMM_BYTES):
+      CASE_CODE(GET_IMM_2BYTES):
+      CASE_CODE(GET_IMM_3BYTES):
+      CASE_CODE(GET_IMM_4BYTES):
+      CASE_CODE(GET_IMM_5BYTES):
+         stack.insert(stack.end(), in.args, in.args + in.argc);
+         break;
+
+      CASE_CODE(STK_COPY):
+         stack.push_back(Top(stack));
+         break;
+
+      CASE_CODE(STK_DROP):
+         Pop(stack);
+         break;
+
+      CASE_CODE(STK_SWAP):
+         if(stack.size() < 2) throw std::runtime_error("stack underflow");
+         std::swap(stack[stack.size() - 1], stack[stack.size() - 2]);
+         break;
+
+      // Flow.
+      CASE_CODE(JMP):
+      {
+         std::uint32_t index = Pop(stack);
+
+         if(index >= module.jumps.size())
+            throw std::runtime_error("bad dynamic jump");
+
+         thread->ip = module.findAddr(module.jumps[index]);
+      }
+         break;
+
+      CASE_CODE(JMP_CAL):
+         call(thread, Pop(stack), false);
+         break;
+
+      CASE_CODE(JMP_CAL_IMM):
+         call(thread, in.args[0], false);
+         break;
+
+      CASE_CODE(JMP_CAL_NIL_IMM):
+         call(thread, in.args[0], true);
+         break;
+
+      CASE_CODE(JMP_HLT):
+         thread->state = TS_SUSPENDED;
+         break;
+
+      CASE_CODE(JMP_IMM):
+         thread->ip = module.findAddr(in.args[0]);
+         break;
+
+      CASE_CODE(JMP_NIL):
+         if(!Pop(stack)) thread->ip = module.findAddr(in.args[0]);
+         break;
+
+      CASE_CODE(JMP_RET):
+         ret(thread, Pop(stack));
+         break;
+
+      CASE_CODE(JMP_RET_NIL):
+         ret(thread, 0);
+         break;
+
+      CASE_CODE(JMP_RET_SCR):
+         thread->state = TS_FINISHED;
+         break;
+
+      CASE_CODE(JMP_RST):
+         thread->ip = thread->script->index;
+         break;
+
+      CASE_CODE(JMP_TAB):
+      {
+         // Cases are sorted by value.
+         std::int32_t value = Top(stack);
+         std::size_t lo = 0, hi = in.argc / 2;
+
+         while(lo < hi)
+         {
+            std::size_t mid = (lo + hi) / 2;
+
+            if(in.args[mid * 2] < value)
+               lo = mid + 1;
+            else
+               hi = mid;
+         }
+
+         if(lo < in.argc / 2 && in.args[lo * 2] == value)
+         {
+            stack.pop_back();
+            thread->ip = module.findAddr(in.args[lo * 2 + 1]);
+         }
+      }
+         break;
+
+      CASE_CODE(JMP_TRU):
+         if(Pop(stack)) thread->ip = module.findAddr(in.args[0]);
+         break;
+
+      CASE_CODE(JMP_VAL):
+         if(Top(stack) == in.args[0])
+         {
+            stack.pop_back();
+            thread->ip = module.findAddr(in.args[1]);
+         }
+         break;
+
+      CASE_CODE(SET_SCRRET):
+         thread->result = Pop(stack);
+         break;
+
+      // Waiting.
+      CASE_CODE(WAIT_SCRIPT):
+      CASE_CODE(WAIT_SCRIPT_IMM):
+         thread->waitScript = in.argc ? in.args[0] : Pop(stack);
+
+         if(isRunning(thread->waitScript))
+            thread->state = TS_WAITING;
+         break;
+
+      CASE_CODE(WAIT_SNAM):
+      {
+         ACSModule::Script const *script =
+            module.findScript(getString(Pop(stack)));
+
+         if(script && isRunning(script->number))
+         {
+            thread->waitScript = script->number;
+            thread->state      = TS_WAITING;
+         }
+      }
+         break;
+
+      CASE_CODE(WAIT_TICS):
+      CASE_CODE(WAIT_TICS_IMM):
+      CASE_CODE(WAIT_TICS_IMM_BYTE):
+      {
+         std::int32_t delay = in.argc ? in.args[0] : Pop(stack);
+
+         if(delay > 0)
+         {
+            thread->wake  = tics + delay;
+            thread->state = TS_DELAYED;
+         }
+      }
+         break;
+
+      // Printing.
+      CASE_CODE(PRINT_START):
+         thread->prints.push_back(std::string());
+         break;
+
+      CASE_CODE(PRINT_END):
+      CASE_CODE(PRINT_END_BOLD):
+      CASE_CODE(PRINT_END_LOG):
+         print(thread);
+         break;
+
+      CASE_CODE(PRINT_END_HUD):
+      CASE_CODE(PRINT_END_HUD_BOLD):
+      {
+         // type, id, color, x, y, and hold time come before any options.
+         std::ptrdiff_t base = thread->optStart == -1 ?
+            static_cast<std::ptrdiff_t>(stack.size()) : thread->optStart;
+
+         if(base < 6 || static_cast<std::size_t>(base) > stack.size())
+            throw std::runtime_error("bad HUD message");
+
+         stack.resize(base - 6);
+         thread->optStart = -1;
+         print(thread);
+      }
+         break;
+
+      CASE_CODE(PRINT_END_OPT):
+         thread->optStart = stack.size();
+         break;
+
+      CASE_CODE(PRINT_END_STR):
+      {
+         if(thread->prints.empty())
+            throw std::runtime_error("no print in progress");
+
+         stack.push_back(strings.size());
+         strings.push_back(thread->prints.back());
+         thread->prints.pop_back();
+      }
+         break;
+
+      CASE_CODE(PRINT_START_OPT):
+         thread->optStart = -1;
+         break;
+
+      CASE_CODE(PRINT_CHARACTER):
+      CASE_CODE(PRINT_KEYBIND):
+      CASE_CODE(PRINT_NUM_BIN):
+      CASE_CODE(PRINT_NUM_DEC):
+      CASE_CODE(PRINT_NUM_DEC_X):
+      CASE_CODE(PRINT_NUM_HEX):
+      CASE_CODE(PRINT_PLAYER_NAME):
+      CASE_CODE(PRINT_STR):
+      CASE_CODE(PRINT_STR_LOCALIZED):
+      {
+         if(thread->prints.empty())
+            throw std::runtime_error("no print in progress");
+
+         std::string &buf = thread->prints.back();
+         std::int32_t value = Pop(stack);
+         char tmp[40];
+
+         switch(in.code)
+         {
+         CASE_CODE(PRINT_CHARACTER):
+            buf += static_cast<char>(value);
+            break;
+
+         CASE_CODE(PRINT_KEYBIND):
+            buf += "[" + getString(value) + "]";
+            break;
+
+         CASE_CODE(PRINT_NUM_BIN):
+         {
+            std::uint32_t bits = value;
+            std::string digits;
+
+            do digits += static_cast<char>('0' + (bits & 1));
+            while(bits >>= 1);
+
+            buf.append(digits.rbegin(), digits.rend());
+         }
+            break;
+
+         CASE_CODE(PRINT_NUM_DEC):
+            std::sprintf(tmp, "%ld", static_cast<long>(value));
+            buf += tmp;
+            break;
+
+         CASE_CODE(PRINT_NUM_DEC_X):
+            std::sprintf(tmp, "%g", value / 65536.0);
+            buf += tmp;
+            break;
+
+         CASE_CODE(PRINT_NUM_HEX):
+            std::sprintf(tmp, "%lX", static_cast<unsigned long>(
+               static_cast<std::uint32_t>(value)));
+            buf += tmp;
+            break;
+
+         CASE_CODE(PRINT_PLAYER_NAME):
+            buf += "Player";
+            break;
+
+         default:
+            buf += getString(value);
+            break;
+         }
+      }
+         break;
+
+      CASE_CODE(PRINT_STR_GBLARR):
+      CASE_CODE(PRINT_STR_GBLRNG):
+      CASE_CODE(PRINT_STR_MAPARR):
+      CASE_CODE(PRINT_STR_MAPRNG):
+      CASE_CODE(PRINT_STR_WLDARR):
+      CASE_CODE(PRINT_STR_WLDRNG):
+      {
+         if(thread->prints.empty())
+            throw std::runtime_error("no print in progress");
+
+         std::int32_t capacity = 0x7FFFFFFF, offset = 0;
+
+         switch(in.code)
+         {
+         CASE_CODE(PRINT_STR_GBLRNG):
+         CASE_CODE(PRINT_STR_MAPRNG):
+         CASE_CODE(PRINT_STR_WLDRNG):
+            capacity = Pop(stack);
+            offset   = Pop(stack);
+            break;
+
+         default:
+            break;
+         }
+
+         std::int32_t array = Pop(stack);
+         offset = Add(offset, Pop(stack));
+
+         std::string &buf = thread->prints.back();
+
+         switch(in.code)
+         {
+         CASE_CODE(PRINT_STR_GBLARR):
+         CASE_CODE(PRINT_STR_GBLRNG):
+            buf += getArrayString(getGlobalArray(array), offset, capacity);
+            break;
+
+         CASE_CODE(PRINT_STR_MAPARR):
+         CASE_CODE(PRINT_STR_MAPRNG):
+            if(std::vector<std::int32_t> *data = getMapArray(array))
+               buf += getArrayString(*data, offset, capacity);
+            break;
+
+         default:
+            buf += getArrayString(getWorldArray(array), offset, capacity);
+            break;
+         }
+      }
+         break;
+
+      // Strings.
+      CASE_CODE(STRING_COPY_GLOBALRANGE):
+      CASE_CODE(STRING_COPY_MAPRANGE):
+      CASE_CODE(STRING_COPY_WORLDRANGE):
+      {
+         std::int32_t srcOffset = Pop(stack);
+         std::string const &src = getString(Pop(stack));
+         std::int32_t capacity = Pop(stack);
+         std::int32_t offset   = Pop(stack);
+         std::int32_t array    = Pop(stack);
+         offset = Add(offset, Pop(stack));
+
+         bool done = false;
+
+         if(srcOffset >= 0 && capacity >= 0 && offset >= 0 &&
+            static_cast<std::size_t>(srcOffset) <= src.size())
+         {
+            std::vector<std::int32_t> *mapArray = NULL;
+            SparseArray *sparse = NULL;
+
+            switch(in.code)
+            {
+            CASE_CODE(STRING_COPY_GLOBALRANGE):
+               sparse = &getGlobalArray(array);
+               break;
+
+            CASE_CODE(STRING_COPY_MAPRANGE):
+               mapArray = getMapArray(array);
+               break;
+
+            default:
+               sparse = &getWorldArray(array);
+               break;
+            }
+
+            for(std::size_t i = srcOffset; capacity-- > 0; ++i, ++offset)
+            {
+               std::int32_t c = i < src.size() ?
+                  static_cast<unsigned char>(src[i]) : 0;
+
+               if(sparse)
+                  (*sparse)[offset] = c;
+               else if(mapArray && static_cast<std::size_t>(offset) < mapArray->size())
+                  (*mapArray)[offset] = c;
+               else
+                  break;
+
+               if(!c) {done = true; break;}
+            }
+         }
+
+         stack.push_back(done);
+      }
+         break;
+
+      CASE_CODE(STRING_GET_LENGTH):
+         Top(stack) = getString(Top(stack)).size();
+         break;
+
+      CASE_CODE(STRING_TAG):
+         break;
+
+      // Math.
+      CASE_CODE(MISC_RANDOM):
+      {
+         std::int32_t max = Pop(stack);
+         Top(stack) = random(Top(stack), max);
+      }
+         break;
+
+      CASE_CODE(MISC_RANDOM_IMM):
+      CASE_CODE(MISC_RANDOM_IMM_BYTE):
+         stack.push_back(random(in.args[0], in.args[1]));
+         break;
+
+      CASE_CODE(TRIG_COS):
+         Top(stack) = static_cast<std::int32_t>(std::floor(
+            std::cos(Top(stack) * (Pi / 32768)) * 65536 + 0.5));
+         break;
+
+      CASE_CODE(TRIG_SIN):
+         Top(stack) = static_cast<std::int32_t>(std::floor(
+            std::sin(Top(stack) * (Pi / 32768)) * 65536 + 0.5));
+         break;
+
+      CASE_CODE(TRIG_VECTORANGLE):
+      {
+         double y = Pop(stack), x = Top(stack);
+         double angle = std::atan2(y, x);
+
+         if(angle < 0) angle += 2 * Pi;
+
+         Top(stack) = static_cast<std::int32_t>(angle * (32768 / Pi)) & 0xFFFF;
+      }
+         break;
+
+      // Game.
+      CASE_CODE(GAME_GET_TIME):
+         stack.push_back(static_cast<std::int32_t>(tics));
+         break;
+
+      CASE_CODE(NATIVE):
+      {
+         std::size_t argc = in.args[0];
+
+         if(stack.size() < argc) throw std::runtime_error("stack underflow");
+
+         std::vector<std::int32_t> args(stack.end() - argc, stack.end());
+         stack.resize(stack.size() - argc);
+
+         std::int32_t result = native(thread, in.args[1], args.data(), argc);
+         stack.push_back(result);
+      }
+         break;
+
+      CASE_CODE(SPECIAL_EXEC1):
+      CASE_CODE(SPECIAL_EXEC2):
+      CASE_CODE(SPECIAL_EXEC3):
+      CASE_CODE(SPECIAL_EXEC4):
+      CASE_CODE(SPECIAL_EXEC5):
+      CASE_CODE(SPECIAL_EXEC5_RETN1):
+      {
+         std::size_t argc = in.code == BinaryTokenZDACS::BCODE_SPECIAL_EXEC5_RETN1 ?
+            5 : in.code - BinaryTokenZDACS::BCODE_SPECIAL_EXEC1 + 1;
+
+         if(stack.size() < argc) throw std::runtime_error("stack underflow");
+
+         std::int32_t args[5];
+         std::copy(stack.end() - argc, stack.end(), args);
+         stack.resize(stack.size() - argc);
+
+         std::int32_t result = special(thread, in.args[0], args, argc);
+
+         if(in.code == BinaryTokenZDACS::BCODE_SPECIAL_EXEC5_RETN1)
+            stack.push_back(result);
+      }
+         break;
+
+      CASE_CODE(SPECIAL_EXEC1_IMM):
+      CASE_CODE(SPECIAL_EXEC2_IMM):
+      CASE_CODE(SPECIAL_EXEC3_IMM):
+      CASE_CODE(SPECIAL_EXEC4_IMM):
+      CASE_CODE(SPECIAL_EXEC5_IMM):
+      CASE_CODE(SPECIAL_EXEC1_IMM_BYTE):
+      CASE_CODE(SPECIAL_EXEC2_IMM_BYTE):
+      CASE_CODE(SPECIAL_EXEC3_IMM_BYTE):
+      CASE_CODE(SPECIAL_EXEC4_IMM_BYTE):
+      CASE_CODE(SPECIAL_EXEC5_IMM_BYTE):
+         special(thread, in.args[0], in.args + 1, in.argc - 1);
+         break;
+
+      default:
+      {
+         int pop, push;
+
+         if(!GetEngineStack(in.code, &pop, &push))
+         {
+            std::ostringstream oss;
+            oss << "unsupported instruction " << in.code;
+            throw std::runtime_error(oss.str());
+         }
+
+         if(stack.size() < static_cast<std::size_t>(pop))
+            throw std::runtime_error("stack underflow");
+
+         stack.resize(stack.size() - pop);
+         stack.resize(stack.size() + push, 0);
+      }
+         break;
+      }
+   }
+}
+
+//
+// ACSVM::getArrayString
+//
+std::string ACSVM::getArrayString(std::vector<std::int32_t> const &array,
+   std::int32_t offset, std::int32_t capacity)
+{
+   std::string s;
+
+   for(; capacity-- > 0 && offset >= 0 &&
+       static_cast<std::size_t>(offset) < array.size() && array[offset];
+       ++offset)
+      s += static_cast<char>(array[offset]);
+
+   return s;
+}
+
+//
+// ACSVM::getArrayString
+//
+std::string ACSVM::getArrayString(SparseArray &array, std::int32_t offset,
+   std::int32_t capacity)
+{
+   std::string s;
+
+   for(; capacity-- > 0 && array[offset]; ++offset)
+      s += static_cast<char>(array[offset]);
+
+   return s;
+}
+
+//
+// ACSVM::getGlobalArray
+//
+ACSVM::SparseArray &ACSVM::getGlobalArray(std::int32_t index)
+{
+   if(index < 0 || static_cast<std::size_t>(index) >= globalArrays.size())
+      throw std::runtime_error("bad global array");
+
+   return globalArrays[index];
+}
+
+//
+// ACSVM::getGlobalReg
+//
+std::int32_t &ACSVM::getGlobalReg(std::int32_t index)
+{
+   if(index < 0 || static_cast<std::size_t>(index) >= globalRegs.size())
+      throw std::runtime_error("bad global register");
+
+   return globalRegs[index];
+}
+
+//
+// ACSVM::getLocal
+//
+std::int32_t &ACSVM::getLocal(Thread *thread, std::int32_t index)
+{
+   std::size_t i = thread->localBase + index;
+
+   if(index < 0 || i >= thread->locals.size())
+      throw std::runtime_error("bad local register");
+
+   return thread->locals[i];
+}
+
+//
+// ACSVM::getMapArray
+//
+std::vector<std::int32_t> *ACSVM::getMapArray(std::int32_t index)
+{
+   std::int32_t array = getMapReg(index);
+
+   if(array < 0 || static_cast<std::size_t>(array) >= mapArrays.size())
+      return NULL;
+
+   return &mapArrays[array];
+}
+
+//
+// ACSVM::getMapArray
+//
+std::int32_t &ACSVM::getMapArray(std::int32_t index, std::int32_t element)
+{
+   std::vector<std::int32_t> *array = getMapArray(index);
+
+   // ZDoom ignores accesses outside of a map array.
+   if(!array || element < 0 || static_cast<std::size_t>(element) >= array->size())
+      return scratch = 0;
+
+   return (*array)[element];
+}
+
+//
+// ACSVM::getMapReg
+//
+std::int32_t &ACSVM::getMapReg(std::int32_t index)
+{
+   if(index < 0 || static_cast<std::size_t>(index) >= mapRegs.size())
+      throw std::runtime_error("bad map register");
+
+   return mapRegs[index];
+}
+
+//
+// ACSVM::getString
+//
+std::string const &ACSVM::getString(std::int32_t index)
+{
+   static std::string const empty;
+
+   if(index < 0 || static_cast<std::size_t>(index) >= strings.size())
+      return empty;
+
+   return strings[index];
+}
+
+//
+// ACSVM::getWorldArray
+//
+ACSVM::SparseArray &ACSVM::getWorldArray(std::int32_t index)
+{
+   if(index < 0 || static_cast<std::size_t>(index) >= worldArrays.size())
+      throw std::runtime_error("bad world array");
+
+   return worldArrays[index];
+}
+
+//
+// ACSVM::getWorldReg
+//
+std::int32_t &ACSVM::getWorldReg(std::int32_t index)
+{
+   if(index < 0 || static_cast<std::size_t>(index) >= worldRegs.size())
+      throw std::runtime_error("bad world register");
+
+   return worldRegs[index];
+}
+
+//
+// ACSVM::isRunning
+//
+bool ACSVM::isRunning(std::int32_t number) const
+{
+   for(auto const &thread : threads)
+   {
+      if(thread.script->number == number && thread.state != TS_FINISHED)
+         return true;
+   }
+
+   return false;
+}
+
+//
+// ACSVM::native
+//
+std::int32_t ACSVM::native(Thread *, std::int32_t func,
+   std::int32_t const *args, std::size_t argc)
+{
+   std::int32_t arg[6] = {0, 0, 0, 0, 0, 0};
+   std::copy(args, args + std::min<std::size_t>(argc, 6), arg);
+
+   switch(func)
+   {
+   case 15: // GetChar
+   {
+      std::string const &s = getString(arg[0]);
+
+      if(arg[1] < 0 || static_cast<std::size_t>(arg[1]) >= s.size())
+         return 0;
+
+      return static_cast<unsigned char>(s[arg[1]]);
+   }
+
+   case 39: // ACS_NamedExecute
+   case 42: // ACS_NamedLockedExecute
+   case 43: // ACS_NamedLockedExecuteDoor
+   case 45: // ACS_NamedExecuteAlways
+      if(ACSModule::Script const *script = module.findScript(getString(arg[0])))
+         return startScript(script, arg + 2, argc > 2 ? argc - 2 : 0, func == 45, false);
+      return 0;
+
+   case 40: // ACS_NamedSuspend
+   case 41: // ACS_NamedTerminate
+      if(ACSModule::Script const *script = module.findScript(getString(arg[0])))
+      {
+         for(auto &thread : threads)
+         {
+            if(thread.script != script || thread.state == TS_FINISHED) continue;
+
+            thread.state = func == 40 ? TS_SUSPENDED : TS_FINISHED;
+         }
+      }
+      return 1;
+
+   case 44: // ACS_NamedExecuteWithResult
+      if(ACSModule::Script const *script = module.findScript(getString(arg[0])))
+         return startScript(script, arg + 1, argc ? argc - 1 : 0, true, true);
+      return 0;
+
+   case 46: // UniqueTID
+   {
+      static std::int32_t tid = 0;
+      return ++tid;
+   }
+
+   case 48: // Sqrt
+      return arg[0] > 0 ? static_cast<std::int32_t>(std::sqrt(double(arg[0]))) : 0;
+
+   case 49: // FixedSqrt
+      return arg[0] > 0 ? static_cast<std::int32_t>(
+         std::sqrt(arg[0] / 65536.0) * 65536) : 0;
+
+   case 50: // VectorLength
+      return static_cast<std::int32_t>(
+         std::sqrt(double(arg[0]) * arg[0] + double(arg[1]) * arg[1]));
+
+   default:
+      return 0;
+   }
+}
+
+//
+// ACSVM::print
+//
+void ACSVM::print(Thread *thread)
+{
+   if(thread->prints.empty())
+      throw std::runtime_error("no print in progress");
+
+   if(out) *out << thread->prints.back() << '\n';
+
+   thread->prints.pop_back();
+}
+
+//
+// ACSVM::random
+//
+// A fixed linear congruential generator, so that runs are repeatable.
+//
+std::int32_t ACSVM::random(std::int32_t min, std::int32_t max)
+{
+   if(max <= min) return min;
+
+   seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+
+   std::uint64_t range = static_cast<std::uint64_t>(
+      static_cast<std::int64_t>(max) - min + 1);
+
+   return static_cast<std::int32_t>(min + (seed >> 32) % range);
+}
+
+//
+// ACSVM::ret
+//
+void ACSVM::ret(Thread *thread, std::int32_t value)
+{
+   if(thread->calls.empty())
+      throw std::runtime_error("return outside of a function");
+
+   CallFrame const &frame = thread->calls.back();
+
+   thread->locals.resize(thread->localBase);
+
+   thread->counter   = frame.counter;
+   thread->ip        = frame.ip;
+   thread->localBase = frame.localBase;
+
+   if(!frame.discard) thread->stack.push_back(value);
+
+   thread->calls.pop_back();
+}
+
+//
+// ACSVM::run
+//
+void ACSVM::run()
+{
+   for(;;)
+   {
+      bool active = false;
+
+      for(auto &thread : threads)
+      {
+         switch(thread.state)
+         {
+         case TS_DELAYED:
+            if(thread.wake > tics) continue;
+            break;
+
+         case TS_WAITING:
+            if(isRunning(thread.waitScript)) continue;
+            break;
+
+         case TS_RUNNING:
+            break;
+
+         default:
+            continue;
+         }
+
+         thread.state = TS_RUNNING;
+         exec(&thread);
+         active = true;
+      }
+
+      for(ThreadList::iterator itr = threads.begin(); itr != threads.end();)
+      {
+         if(itr->state == TS_FINISHED)
+            itr = threads.erase(itr);
+         else
+            ++itr;
+      }
+
+      // Find the next tic anything can run on.
+      std::uint64_t next = 0;
+      bool pending = false;
+
+      for(auto const &thread : threads)
+      {
+         if(thread.state == TS_RUNNING ||
+            (thread.state == TS_WAITING && !isRunning(thread.waitScript)))
+         {
+            next = tics + 1;
+            pending = true;
+            break;
+         }
+
+         if(thread.state == TS_DELAYED && (!pending || thread.wake < next))
+         {
+            next = thread.wake;
+            pending = true;
+         }
+      }
+
+      // Everything left is suspended or waiting on something that is.
+      if(!pending) break;
+
+      if(!active && next <= tics) next = tics + 1;
+
+      tics = std::max(next, tics + 1);
+
+      if(limitTics && tics > limitTics)
+         throw std::runtime_error("tic limit reached");
+   }
+}
+
+//
+// ACSVM::special
+//
+std::int32_t ACSVM::special(Thread *, std::int32_t spec,
+   std::int32_t const *args, std::size_t argc)
+{
+   std::int32_t arg[5] = {0, 0, 0, 0, 0};
+   std::copy(args, args + std::min<std::size_t>(argc, 5), arg);
+
+   switch(spec)
+   {
+   case 80:  // ACS_Execute
+   case 83:  // ACS_LockedExecute
+   case 85:  // ACS_LockedExecuteDoor
+   case 226: // ACS_ExecuteAlways
+      if(ACSModule::Script const *script = module.findScript(arg[0]))
+         return startScript(script, arg + 2, 3, spec == 226, false);
+      return 0;
+
+   case 81: // ACS_Suspend
+   case 82: // ACS_Terminate
+      for(auto &thread : threads)
+      {
+         if(thread.script->number != arg[0] || thread.state == TS_FINISHED)
+            continue;
+
+         thread.state = spec == 81 ? TS_SUSPENDED : TS_FINISHED;
+      }
+      return 1;
+
+   case 84: // ACS_ExecuteWithResult
+      if(ACSModule::Script const *script = module.findScript(arg[0]))
+         return startScript(script, arg + 1, 4, true, true);
+      return 0;
+
+   default:
+      return 0;
+   }
+}
+
+//
+// ACSVM::start
+//
+void ACSVM::start(ACSModule::Script const *script,
+   std::vector<std::int32_t> const &args)
+{
+   startScript(script, args.data(), args.size(), true, false);
+}
+
+//
+// ACSVM::startScript
+//
+// Unless always is set, a script that is already running is only resumed if
+// suspended. If now is set, the new thread runs until it first stops and its
+// result is returned.
+//
+std::int32_t ACSVM::startScript(ACSModule::Script const *script,
+   std::int32_t const *args, std::size_t argc, bool always, bool now)
+{
+   if(!always)
+   {
+      for(auto &thread : threads)
+      {
+         if(thread.script != script || thread.state == TS_FINISHED) continue;
+
+         if(thread.state != TS_SUSPENDED) return 0;
+
+         thread.state = TS_RUNNING;
+         return 1;
+      }
+   }
+
+   Thread thread;
+   thread.script     = script;
+   thread.counter    = &scriptCounts[script - module.scripts.data()];
+   thread.ip         = script->index;
+   thread.localBase  = 0;
+   thread.wake       = 0;
+   thread.result     = 0;
+   thread.waitScript = 0;
+   thread.optStart   = -1;
+   thread.state      = TS_RUNNING;
+
+   thread.locals.assign(std::max<std::size_t>(script->varCount, script->argCount), 0);
+
+   for(std::size_t i = 0; i != argc && i != thread.locals.size(); ++i)
+      thread.locals[i] = args[i];
+
+   ++thread.counter->calls;
+
+   ThreadList::iterator itr = threads.insert(threads.end(), thread);
+
+   if(!now) return 1;
+
+   exec(&*itr);
+
+   return itr->result;
+}
+
+// EOF
+
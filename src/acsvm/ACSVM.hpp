@@ -0,0 +1,197 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Reference ACS interpreter.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef HPP_ACSVM_
+#define HPP_ACSVM_
+
+#include "ACSModule.hpp"
+
+#include <list>
+#include <ostream>
+#include <unordered_map>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// ACSVM
+//
+// Runs the scripts of one module headlessly. Engine interaction is stubbed
+// out, but everything the code can observe of itself (variables, arrays,
+// calls, strings, and printing) behaves as in ZDoom. Every executed
+// instruction is counted against the script or function it belongs to.
+//
+class ACSVM
+{
+public:
+   //
+   // Counter
+   //
+   struct Counter
+   {
+      Counter() : instructions(0), calls(0) {}
+
+      std::uint64_t instructions;
+      std::uint64_t calls;
+   };
+
+
+   explicit ACSVM(ACSModule const &module);
+
+   // Runs until every thread has finished or is suspended.
+   void run();
+
+   // Starts a thread for script.
+   void start(ACSModule::Script const *script,
+              std::vector<std::int32_t> const &args);
+
+   std::vector<Counter>       functionCounts;
+   std::vector<Counter>       scriptCounts;
+   std::vector<std::uint64_t> codeCounts;
+
+   std::uint64_t instructions;
+   std::uint64_t tics;
+
+   std::uint64_t limitInstructions; // 0 for no limit.
+   std::uint64_t limitTics;         // 0 for no limit.
+   std::uint64_t seed;
+
+   std::ostream *out; // Where printing goes. NULL to discard.
+
+private:
+   //
+   // SparseArray
+   //
+   // World and global arrays can use any index.
+   //
+   class SparseArray
+   {
+   public:
+      std::int32_t &operator [] (std::int32_t index);
+
+   private:
+      std::vector<std::int32_t> low;
+      std::unordered_map<std::int32_t, std::int32_t> high;
+   };
+
+   //
+   // CallFrame
+   //
+   struct CallFrame
+   {
+      Counter    *counter;
+      std::size_t ip;
+      std::size_t localBase;
+      bool        discard;
+   };
+
+   enum ThreadState
+   {
+      TS_RUNNING,
+      TS_DELAYED,
+      TS_WAITING,
+      TS_SUSPENDED,
+      TS_FINISHED,
+   };
+
+   //
+   // Thread
+   //
+   struct Thread
+   {
+      ACSModule::Script const  *script;
+      Counter                  *counter;
+      std::vector<std::int32_t> stack;
+      std::vector<std::int32_t> locals;
+      std::vector<CallFrame>    calls;
+      std::vector<std::string>  prints;
+      std::size_t               ip;
+      std::size_t               localBase;
+      std::uint64_t             wake;
+      std::int32_t              result;
+      std::int32_t              waitScript;
+      std::ptrdiff_t            optStart;
+      ThreadState               state;
+   };
+
+   typedef std::list<Thread> ThreadList;
+
+
+   void call(Thread *thread, std::size_t index, bool discard);
+
+   void exec(Thread *thread);
+   void execCode(Thread *thread);
+
+   std::string getArrayString(std::vector<std::int32_t> const &array,
+                              std::int32_t offset, std::int32_t capacity);
+   std::string getArrayString(SparseArray &array, std::int32_t offset,
+                              std::int32_t capacity);
+
+   std::int32_t &getGlobalReg(std::int32_t index);
+   std::int32_t &getLocal(Thread *thread, std::int32_t index);
+   std::vector<std::int32_t> *getMapArray(std::int32_t index);
+   std::int32_t &getMapArray(std::int32_t index, std::int32_t element);
+   std::int32_t &getMapReg(std::int32_t index);
+   SparseArray  &getGlobalArray(std::int32_t index);
+   SparseArray  &getWorldArray(std::int32_t index);
+   std::int32_t &getWorldReg(std::int32_t index);
+
+   std::string const &getString(std::int32_t index);
+
+   bool isRunning(std::int32_t number) const;
+
+   std::int32_t native(Thread *thread, std::int32_t func,
+                       std::int32_t const *args, std::size_t argc);
+
+   void print(Thread *thread);
+
+   std::int32_t random(std::int32_t min, std::int32_t max);
+
+   void ret(Thread *thread, std::int32_t value);
+
+   std::int32_t special(Thread *thread, std::int32_t spec,
+                        std::int32_t const *args, std::size_t argc);
+
+   std::int32_t startScript(ACSModule::Script const *script,
+                            std::int32_t const *args, std::size_t argc,
+                            bool always, bool now);
+
+   ACSModule const &module;
+
+   ThreadList threads;
+
+   std::vector<std::vector<std::int32_t> > mapArrays;
+   std::vector<std::int32_t> mapRegs;
+   std::vector<std::int32_t> worldRegs;
+   std::vector<std::int32_t> globalRegs;
+   std::vector<SparseArray>  worldArrays;
+   std::vector<SparseArray>  globalArrays;
+   std::vector<std::string>  strings;
+
+   std::int32_t scratch; // Target for out of bounds map array access.
+};
+
+#endif//HPP_ACSVM_
+
@@ -0,0 +1,341 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Reference ACS interpreter start point.
+//
+// Runs the scripts of a compiled lump without a game and reports how many
+// instructions each script and function executed, so that the output of
+// different compiler versions and options can be compared directly.
+//
+//-----------------------------------------------------------------------------
+
+#include "ACSModule.hpp"
+#include "ACSVM.hpp"
+
+#include "../option.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// ReportEntry
+//
+struct ReportEntry
+{
+   std::string   name;
+   std::uint64_t instructions;
+   std::uint64_t calls;
+};
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static option::option_data<std::vector<std::string> > option_arg
+('a', "arg", "execution",
+ "Adds an argument for the scripts run. May be given more than once.", NULL);
+
+static option::option_data<int> option_max_instructions
+('\0', "max-instructions", "execution",
+ "Stops with an error after this many instructions. 0 for no limit, which "
+ "is the default.", NULL, 0);
+
+static option::option_data<int> option_max_tics
+('\0', "max-tics", "execution",
+ "Stops with an error after this many tics. 0 for no limit, which is the "
+ "default.", NULL, 0);
+
+static option::option_data<bool> option_print
+('\0', "print", "output",
+ "Writes printed messages to stdout. On by default.", NULL, true);
+
+static option::option_data<std::string> option_report
+('r', "report", "output",
+ "Indicates a file to write the instruction count report to. Use - to dump "
+ "to stdout. stderr by default.", NULL);
+
+static option::option_data<bool> option_report_codes
+('\0', "report-codes", "output",
+ "Includes a count of each executed instruction in the report.", NULL, false);
+
+static option::option_data<std::vector<std::string> > option_script
+('s', "script", "execution",
+ "Runs a script, by number or name, after the open scripts. May be given "
+ "more than once. By default, the enter scripts are run.", NULL);
+
+static option::option_data<int> option_seed
+('\0', "seed", "execution",
+ "Sets the seed for random numbers. 0 by default.", NULL, 0);
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// AddEntry
+//
+static void AddEntry(std::vector<ReportEntry> *entries, std::string const &name,
+   ACSVM::Counter const &counter)
+{
+   if(!counter.calls && !counter.instructions) return;
+
+   ReportEntry entry;
+   entry.name         = name;
+   entry.instructions = counter.instructions;
+   entry.calls        = counter.calls;
+
+   entries->push_back(entry);
+}
+
+//
+// EntryLess
+//
+// Most instructions first.
+//
+static bool EntryLess(ReportEntry const &l, ReportEntry const &r)
+{
+   if(l.instructions != r.instructions) return l.instructions > r.instructions;
+   return l.name < r.name;
+}
+
+//
+// FindScript
+//
+static ACSModule::Script const *FindScript(ACSModule const &module,
+   std::string const &name)
+{
+   char *end;
+   long number = std::strtol(name.c_str(), &end, 0);
+
+   if(!*end && end != name.c_str())
+      return module.findScript(static_cast<std::int32_t>(number));
+
+   return module.findScript(name);
+}
+
+//
+// GetScriptName
+//
+static std::string GetScriptName(ACSModule::Script const &script)
+{
+   std::ostringstream oss;
+
+   oss << "script ";
+
+   if(script.name.empty())
+      oss << script.number;
+   else
+      oss << '"' << script.name << '"';
+
+   oss << " (" << ACSModule::GetScriptType(script.type) << ')';
+
+   return oss.str();
+}
+
+//
+// WriteReport
+//
+static void WriteReport(std::ostream *out, ACSModule const &module,
+   ACSVM const &vm)
+{
+   std::vector<ReportEntry> entries;
+
+   for(std::size_t i = 0, e = module.scripts.size(); i != e; ++i)
+      AddEntry(&entries, GetScriptName(module.scripts[i]), vm.scriptCounts[i]);
+
+   for(std::size_t i = 0, e = module.functions.size(); i != e; ++i)
+   {
+      std::ostringstream oss;
+      oss << "function ";
+
+      if(module.functions[i].name.empty())
+         oss << i;
+      else
+         oss << module.functions[i].name;
+
+      AddEntry(&entries, oss.str(), vm.functionCounts[i]);
+   }
+
+   std::sort(entries.begin(), entries.end(), EntryLess);
+
+   *out << "# " << module.filename << ": " << vm.instructions
+        << " instructions, " << vm.tics << " tics\n";
+
+   for(auto const &entry : entries)
+   {
+      *out << entry.instructions << ' ' << entry.calls << ' ' << entry.name
+           << '\n';
+   }
+
+   if(option_report_codes.data)
+   {
+      *out << "# instructions\n";
+
+      for(std::size_t i = 0, e = vm.codeCounts.size(); i != e; ++i)
+      {
+         if(vm.codeCounts[i])
+            *out << vm.codeCounts[i] << " code " << i << '\n';
+      }
+   }
+}
+
+//
+// _init
+//
+static void _init(int argc, char const *const *argv)
+{
+   option::help_program = argv[0];
+   option::help_usage   = "[option]... lump";
+   option::help_desc_s  = "Runs a compiled ACS lump and counts instructions.";
+
+   if(argc == 1)
+   {
+      option::print_help(stderr);
+      throw 0;
+   }
+
+   option::process_options(argc-1, argv+1, option::OPTF_KEEPA);
+
+   if(option::option_args::arg_count != 1)
+   {
+      option::print_help(stderr);
+      throw 1;
+   }
+}
+
+//
+// _main
+//
+static int _main()
+{
+   ACSModule module(option::option_args::arg_vector[0]);
+   ACSVM vm(module);
+
+   vm.limitInstructions = option_max_instructions.data;
+   vm.limitTics         = option_max_tics.data;
+   vm.seed              = static_cast<unsigned>(option_seed.data);
+
+   if(option_print.data) vm.out = &std::cout;
+
+   std::vector<std::int32_t> args;
+   for(auto const &arg : option_arg.data)
+      args.push_back(static_cast<std::int32_t>(std::strtol(arg.c_str(), NULL, 0)));
+
+   // Open scripts are what initialize statics, so they always come first.
+   for(auto const &script : module.scripts)
+      if(script.type == 1) vm.start(&script, args);
+
+   if(option_script.data.empty())
+   {
+      for(auto const &script : module.scripts)
+         if(script.type == 4) vm.start(&script, args);
+   }
+   else for(auto const &name : option_script.data)
+   {
+      ACSModule::Script const *script = FindScript(module, name);
+
+      if(!script)
+      {
+         std::cerr << module.filename << ": no script " << name << '\n';
+         return EXIT_FAILURE;
+      }
+
+      vm.start(script, args);
+   }
+
+   int result = 0;
+
+   try
+   {
+      vm.run();
+   }
+   catch(std::runtime_error const &e)
+   {
+      std::cerr << module.filename << ": " << e.what() << '\n';
+      result = EXIT_FAILURE;
+   }
+
+   std::cout.flush();
+
+   // The report is still written after an error to show where time went.
+   if(option_report.data.empty())
+      WriteReport(&std::cerr, module, vm);
+   else if(option_report.data == "-")
+      WriteReport(&std::cout, module, vm);
+   else
+   {
+      std::ofstream out(option_report.data.c_str());
+
+      if(!out)
+      {
+         std::cerr << "Failed to open '" << option_report.data << "' for writing.\n";
+         return EXIT_FAILURE;
+      }
+
+      WriteReport(&out, module, vm);
+   }
+
+   return result;
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// main
+//
+int main(int argc, char *argv[])
+{
+   try
+   {
+      _init(argc, argv);
+
+      return _main();
+   }
+   catch(option::exception const &e)
+   {
+      std::cerr << "(option::exception): " << e.what() << std::endl;
+      option::print_help(stderr);
+   }
+   catch(std::exception const &e)
+   {
+      std::cerr << e.what() << std::endl;
+   }
+   catch(int e)
+   {
+      return e;
+   }
+
+   return EXIT_FAILURE;
+}
+
+// EOF
+
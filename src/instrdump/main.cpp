@@ -0,0 +1,244 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Instrumentation counter reader start point.
+//
+// Joins the counters logged by an instrumented module's dump script with the
+// map written by DH-acc, so each count is shown with the function and source
+// position it belongs to.
+//
+//-----------------------------------------------------------------------------
+
+#include "../option.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// Counter
+//
+struct Counter
+{
+   std::string kind;
+   std::string name;
+   std::string pos;
+   unsigned long count;
+   unsigned long index;
+};
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static option::option_data<bool> option_zero
+('\0', "zero", "output",
+ "Lists counters that were never reached, too.", NULL, false);
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// CompareCount
+//
+// Orders counters by count, highest first, then by index.
+//
+static bool CompareCount(Counter const &l, Counter const &r)
+{
+   if(l.count != r.count) return l.count > r.count;
+
+   return l.index < r.index;
+}
+
+//
+// ReadLog
+//
+// Finds every "instrument <index> <count>" in the log. Anything else on the
+// line, such as a timestamp, is skipped.
+//
+static void ReadLog(std::istream *in, std::vector<Counter> *counters)
+{
+   static std::string const tag = "instrument ";
+
+   std::string line;
+
+   while(std::getline(*in, line))
+   {
+      std::string::size_type pos = line.find(tag);
+      if(pos == std::string::npos) continue;
+
+      std::istringstream iss(line.substr(pos + tag.size()));
+      unsigned long index, count;
+
+      if(!(iss >> index >> count)) continue;
+
+      if(index >= counters->size())
+      {
+         std::cerr << "Counter " << index << " is not in the map.\n";
+         throw 1;
+      }
+
+      (*counters)[index].count = count;
+   }
+}
+
+//
+// ReadMap
+//
+static void ReadMap(std::istream *in, std::vector<Counter> *counters)
+{
+   std::string line;
+
+   while(std::getline(*in, line))
+   {
+      if(line.empty() || line[0] == '#') continue;
+
+      std::istringstream iss(line);
+      Counter counter;
+
+      if(!(iss >> counter.index >> counter.kind >> counter.name))
+         continue;
+
+      std::getline(iss >> std::ws, counter.pos);
+      counter.count = 0;
+
+      if(counter.index >= counters->size())
+         counters->resize(counter.index + 1);
+
+      (*counters)[counter.index] = counter;
+   }
+}
+
+//
+// _init
+//
+static void _init(int argc, char const *const *argv)
+{
+   option::help_program = argv[0];
+   option::help_usage   = "[option]... map [log]";
+   option::help_desc_s  = "Lists the counts from an instrumented module's dump "
+                          "script. Reads the log from stdin by default.";
+
+   if(argc == 1)
+   {
+      option::print_help(stderr);
+      throw 0;
+   }
+
+   option::process_options(argc-1, argv+1, option::OPTF_KEEPA);
+
+   if(option::option_args::arg_count < 1 || option::option_args::arg_count > 2)
+   {
+      option::print_help(stderr);
+      throw 1;
+   }
+}
+
+//
+// _main
+//
+static int _main()
+{
+   char const *const *args = option::option_args::arg_vector;
+   std::vector<Counter> counters;
+
+   std::ifstream map(args[0]);
+   if(!map)
+   {
+      std::cerr << "Failed to open '" << args[0] << "' for reading.\n";
+      return EXIT_FAILURE;
+   }
+
+   ReadMap(&map, &counters);
+
+   if(option::option_args::arg_count == 2)
+   {
+      std::ifstream log(args[1]);
+      if(!log)
+      {
+         std::cerr << "Failed to open '" << args[1] << "' for reading.\n";
+         return EXIT_FAILURE;
+      }
+
+      ReadLog(&log, &counters);
+   }
+   else
+      ReadLog(&std::cin, &counters);
+
+   std::stable_sort(counters.begin(), counters.end(), CompareCount);
+
+   for(auto const &counter : counters)
+   {
+      if(!counter.count && !option_zero.data) continue;
+      if(counter.kind.empty()) continue;
+
+      std::cout << counter.count << ' ' << counter.kind << ' ' << counter.name
+                << ' ' << counter.pos << '\n';
+   }
+
+   return 0;
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// main
+//
+int main(int argc, char *argv[])
+{
+   try
+   {
+      _init(argc, argv);
+
+      return _main();
+   }
+   catch(option::exception const &e)
+   {
+      std::cerr << "(option::exception): " << e.what() << std::endl;
+      option::print_help(stderr);
+   }
+   catch(std::exception const &e)
+   {
+      std::cerr << e.what() << std::endl;
+   }
+   catch(int e)
+   {
+      return e;
+   }
+
+   return EXIT_FAILURE;
+}
+
+// EOF
+
@@ -28,6 +28,7 @@
 #include "ObjectArchive.hpp"
 #include "ObjectData.hpp"
 #include "ObjectExpression.hpp"
+#include "ObjectLibrary.hpp"
 #include "ObjectToken.hpp"
 #include "ObjectVector.hpp"
 #include "option.hpp"
@@ -46,16 +47,42 @@
 #include "VariableData.hpp"
 #include "VariableType.hpp"
 
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <vector>
 
+#ifndef __WIN32__
+#include <sys/resource.h>
+#endif
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// PhaseTime
+//
+struct PhaseTime
+{
+   char const *name;
+   double      seconds;
+   long        peakKiB;
+};
+
 
 //----------------------------------------------------------------------------|
 // Static Variables                                                           |
 //
 
+static option::option_data<std::string> option_annotate
+('\0', "annotate", "output",
+ "Indicates a file to list the bytes and instructions of the final output "
+ "for each function and source line to. Use - to dump to stdout. Not "
+ "supported for MageCraft.", NULL);
+
 static option::option_data<std::string> option_ocode_list_debug
 ('\0', "debug-ocode-list", "debugging",
  "Indicates a file to list all OCODEs to. Use - to dump to stdout.", NULL);
@@ -63,6 +90,17 @@ static option::option_data<std::string> option_ocode_list_debug
 static option::option_data<std::string> option_out
 ('o', "out", "output", "Output File.", NULL);
 
+static option::option_data<std::string> option_layout_map
+('\0', "layout-map", "output",
+ "Indicates a file to list the layout of statics and array variables to, "
+ "with a summary of each area. Use - to dump to stdout.", NULL);
+
+static option::option_data<bool> option_gc_sections
+('\0', "gc-sections", "optimization",
+ "Removes functions, statics, strings, and internal map variables that "
+ "cannot be reached from scripts or exported variables when linking.",
+ NULL, false);
+
 static option::option_data<bool> option_init_code
 ('\0', "init-code", "features",
  "Enables the implicit creation of an initialization function/script for "
@@ -85,6 +123,26 @@ static option::option_data<std::string> option_static_list_debug
 ('\0', "debug-static-list", "debugging",
  "Indicates a file to list all statics to. Use - to dump to stdout.", NULL);
 
+static option::option_data<std::string> option_instrument
+('\0', "instrument", "debugging",
+ "Counts executions of every function and script, or of every basic block. "
+ "Takes functions or blocks. Requires a target with global arrays.", NULL);
+
+static option::option_data<std::string> option_instrument_map
+('\0', "instrument-map", "debugging",
+ "Indicates a file to list each instrumentation counter's function and "
+ "source position to. Use - to dump to stdout. The output file with .imap "
+ "appended by default.", NULL);
+
+static option::option_data<std::string> option_time_report
+('\0', "time-report", "debugging",
+ "Indicates a file to write the time taken and peak memory use at the end "
+ "of each compilation phase to. Use - to dump to stdout.", NULL);
+
+static std::vector<PhaseTime> PhaseTimes;
+static char const *PhaseName = NULL;
+static std::chrono::steady_clock::time_point PhaseStart;
+
 
 //----------------------------------------------------------------------------|
 // Static Functions                                                           |
@@ -123,6 +181,11 @@ static SourceType divine_source_type(std::string const &name)
       if (buf[0] == 'o' && buf[1] == 'b' && buf[2] == 'j' &&
          buf[3] == 'e' && buf[4] == 'c' && buf[5] == 't')
          return SOURCE_object;
+
+      // archive source?
+      if (buf[0] == 'a' && buf[1] == 'r' && buf[2] == 'c' && buf[3] == 'h' &&
+         buf[4] == 'i' && buf[5] == 'v' && buf[6] == 'e')
+         return SOURCE_archive;
    }
 
 
@@ -150,6 +213,10 @@ static SourceType divine_source_type(std::string const &name)
    if (suf[0] == 'o' && suf[1] == 'b' && suf[2] == 'j' && suf[3] == '\0')
       return SOURCE_object;
 
+   // archive source?
+   if (suf[0] == 'a' && suf[1] == '\0')
+      return SOURCE_archive;
+
 
    return SOURCE_UNKNOWN;
 }
@@ -201,6 +268,29 @@ static void dump_static_debug(std::ostream *out, ObjectData::Static const &s)
    *out << s.name << ' ' << s.number << ' ' << s.size << '\n';
 }
 
+//
+// get_peak_kib
+//
+// Returns the peak resident set size of the process in KiB, or 0 if it is not
+// known.
+//
+static long get_peak_kib()
+{
+   #if defined(__WIN32__)
+   return 0;
+   #else
+   struct rusage usage;
+
+   if(getrusage(RUSAGE_SELF, &usage)) return 0;
+
+   #if defined(__APPLE__)
+   return usage.ru_maxrss / 1024;
+   #else
+   return usage.ru_maxrss;
+   #endif
+   #endif
+}
+
 //
 // read_source
 //
@@ -214,8 +304,16 @@ static void read_source(std::string const &name, SourceType type,
    if(type == SOURCE_UNKNOWN)
       type = divine_source_type(name);
 
+   // Archives are only made from objects.
+   if(Output == OUTPUT_archive && type != SOURCE_archive && type != SOURCE_object)
+      throw "Archive members must be object files.";
+
    switch(type)
    {
+   case SOURCE_archive:
+      ObjectLibrary::Read(name);
+      break;
+
    case SOURCE_ASM:
       {
          SourceStream in(name, SourceStream::ST_ASM);
@@ -248,6 +346,9 @@ static void read_source(std::string const &name, SourceType type,
       break;
 
    case SOURCE_object:
+      if(Output == OUTPUT_archive)
+         ObjectLibrary::AddMember(name, objects);
+      else
       {
          std::ifstream in(name.c_str(), std::ios_base::in|std::ios_base::binary);
 
@@ -291,6 +392,68 @@ static void read_source(std::string const &name, SourceType type,
    }
 }
 
+//
+// time_phase
+//
+// Ends the current phase, if any, and starts the named one, if any.
+//
+static void time_phase(char const *name)
+{
+   if(option_time_report.data.empty()) return;
+
+   std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+   if(PhaseName)
+   {
+      PhaseTime phase;
+      phase.name    = PhaseName;
+      phase.seconds = std::chrono::duration<double>(now - PhaseStart).count();
+      phase.peakKiB = get_peak_kib();
+
+      PhaseTimes.push_back(phase);
+   }
+
+   PhaseName  = name;
+   PhaseStart = now;
+}
+
+//
+// write_annotation
+//
+template<typename T> static void write_annotation(std::vector<T> const &instructions)
+{
+   if(option_annotate.data.empty()) return;
+
+   if(option_annotate.data == "-")
+      BinaryTokenACS::output_annotate(&std::cout, instructions);
+   else
+   {
+      std::ofstream ofs(option_annotate.data.c_str());
+      BinaryTokenACS::output_annotate(&ofs, instructions);
+   }
+}
+
+//
+// write_time_report
+//
+static void write_time_report(std::ostream *out)
+{
+   double total = 0;
+
+   out->setf(std::ios_base::fixed, std::ios_base::floatfield);
+   out->precision(6);
+
+   *out << "# phase seconds peak-KiB\n";
+
+   for(auto const &phase : PhaseTimes)
+   {
+      *out << phase.name << ' ' << phase.seconds << ' ' << phase.peakKiB << '\n';
+      total += phase.seconds;
+   }
+
+   *out << "total " << total << ' ' << get_peak_kib() << '\n';
+}
+
 //
 // _init
 //
@@ -344,12 +507,33 @@ static inline int _main()
       Target = TARGET_Hexen;
 
    // Read source file(s).
+   time_phase("read");
    for (char const **iter = option::option_args::arg_vector,
                    **end  = option::option_args::arg_count+iter;
         iter != end; ++iter)
       read_source(*iter, Source, &objects);
 
+   // If doing archive output, the members are all that is needed.
+   if(Output == OUTPUT_archive)
+   {
+      time_phase("write");
+
+      std::ofstream out(option_out.data.c_str(),
+                        std::ios_base::out|std::ios_base::binary);
+
+      if(!out)
+      {
+         std::cerr << "Failed to open '" << option_out.data << "' for writing.\n";
+         return EXIT_FAILURE;
+      }
+
+      ObjectLibrary::Write(&out);
+
+      return 0;
+   }
+
    // Generate functions.
+   time_phase("codegen");
    for(SourceFunction::FuncMap::iterator itr = SourceFunction::FunctionTable.begin(),
        end = SourceFunction::FunctionTable.end(); itr != end; ++itr)
    {
@@ -390,11 +574,20 @@ static inline int _main()
       if(exprRetn) exprRetn->makeObjects(&objects, VariableData::create_void(0));
    }
 
+   // Pull in whatever library members are needed.
+   if(Output != OUTPUT_object)
+   {
+      time_phase("link");
+      ObjectLibrary::Link(&objects);
+   }
+
    objects.addToken(OCODE_NOP);
 
    // If doing object output, don't process object data.
    if(Output == OUTPUT_object)
    {
+      time_phase("write");
+
       std::ofstream out(option_out.data.c_str(),
                         std::ios_base::out|std::ios_base::binary);
 
@@ -411,9 +604,53 @@ static inline int _main()
    }
 
    // Process object data.
+   if(option_gc_sections.data)
+   {
+      time_phase("gc");
+      objects.optimize_gc();
+   }
+
+   // Insert counters, if requested. Done before allocation so the counter
+   // array and dump script get numbers, and before optimization so they are
+   // optimized like any other code.
+   if(!option_instrument.data.empty())
+   {
+      time_phase("instrument");
+
+      std::string mapName = option_instrument_map.data;
+      if(mapName.empty())
+         mapName = option_out.data + ".imap";
+
+      if(mapName == "-")
+         objects.instrument(option_instrument.data, &std::cout);
+      else
+      {
+         std::ofstream ofs(mapName.c_str());
+         objects.instrument(option_instrument.data, &ofs);
+      }
+   }
+
+   time_phase("allocate");
+   ObjectData::Layout::FindUse(objects);
    ObjectExpression::do_deferred_allocation();
+
+   time_phase("optimize");
    objects.optimize();
 
+   time_phase("dump");
+
+   // Write layout map, if requested.
+   if (!option_layout_map.data.empty())
+   {
+      if (option_layout_map.data == "-")
+         ObjectData::Layout::WriteMap(&std::cout);
+      else
+      {
+         std::ofstream ofs(option_layout_map.data.c_str());
+         ObjectData::Layout::WriteMap(&ofs);
+      }
+   }
+
    // Dump maparray list, if requested.
    if (option_maparray_list_debug.handled)
    {
@@ -485,6 +722,8 @@ static inline int _main()
    }
 
    // Write output file.
+   time_phase("write");
+
    std::ofstream ofs(option_out.data.c_str(),
                      std::ios_base::out|std::ios_base::binary);
 
@@ -501,6 +740,7 @@ static inline int _main()
       std::vector<BinaryTokenACS> instructions;
       BinaryTokenACS::make_tokens(objects, &instructions);
       BinaryTokenACS::write_all(&ofs, instructions);
+      write_annotation(instructions);
    }
       break;
 
@@ -510,6 +750,7 @@ static inline int _main()
       std::vector<BinaryTokenZDACS> instructions;
       BinaryTokenZDACS::make_tokens(objects, &instructions);
       BinaryTokenZDACS::write_all(&ofs, instructions);
+      write_annotation(instructions);
    }
       break;
 
@@ -542,7 +783,22 @@ int main(int argc, char *argv[])
    {
       _init(argc, argv);
 
-      return _main();
+      int result = _main();
+
+      // Write time report, if requested.
+      time_phase(NULL);
+      if (!option_time_report.data.empty())
+      {
+         if (option_time_report.data == "-")
+            write_time_report(&std::cout);
+         else
+         {
+            std::ofstream ofs(option_time_report.data.c_str());
+            write_time_report(&ofs);
+         }
+      }
+
+      return result;
    }
    catch (SourceException const &e)
    {
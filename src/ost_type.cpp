@@ -35,6 +35,7 @@
 static TargetType GetTarget(char const *target);
 
 static int OutputHandler(char const *opt, int optf, int argc, char const *const *argv);
+static int Output_archive(char const *opt, int optf, int argc, char const *const *argv);
 static int Output_object(char const *opt, int optf, int argc, char const *const *argv);
 
 static int SourceHandler(char const *opt, int optf, int argc, char const *const *argv);
@@ -52,6 +53,9 @@ static int TuneHandler(char const *opt, int optf, int argc, char const *const *a
 static option::option_call option_Output
 ('\0', "output-type", "output", "Output type.", NULL, OutputHandler);
 
+static option::option_call option_Output_archive
+('\0', "archive", "output", "Equal to --output-type=archive.", NULL, Output_archive);
+
 static option::option_call option_Output_object
 ('c', NULL, "output", "Equal to --output-type=object.", NULL, Output_object);
 
@@ -105,8 +109,12 @@ static int OutputHandler(char const *opt, int optf, int argc, char const *const
       Output = OUTPUT_ACS0;
    else if(!strcmp(argv[0], "ACSE"))
       Output = OUTPUT_ACSE;
+   else if(!strcmp(argv[0], "ACSe"))
+      Output = OUTPUT_ACSe;
    else if(!strcmp(argv[0], "ACS+"))
       Output = OUTPUT_ACSP;
+   else if(!strcmp(argv[0], "archive"))
+      Output = OUTPUT_archive;
    else if(!strcmp(argv[0], "object"))
       Output = OUTPUT_object;
    else if(!std::strcmp(argv[0], "NTS0"))
@@ -117,6 +125,16 @@ static int OutputHandler(char const *opt, int optf, int argc, char const *const
    return 1;
 }
 
+//
+// Output_archive
+//
+static int Output_archive(char const *, int, int, char const *const *)
+{
+   Output = OUTPUT_archive;
+
+   return 0;
+}
+
 //
 // Output_object
 //
@@ -136,6 +154,8 @@ static int SourceHandler(char const *opt, int optf, int argc, char const *const
 
    if(!strcmp(argv[0], "ASM"))
       Source = SOURCE_ASM;
+   else if(!strcmp(argv[0], "archive"))
+      Source = SOURCE_archive;
    else if(!strcmp(argv[0], "C"))
       Source = SOURCE_C;
    else if(!strcmp(argv[0], "DS"))
@@ -36,7 +36,9 @@ enum OutputType
 {
    OUTPUT_ACS0,
    OUTPUT_ACSE,
+   OUTPUT_ACSe,
    OUTPUT_ACSP,
+   OUTPUT_archive,
    OUTPUT_object,
    OUTPUT_NTS0,
 
@@ -49,6 +51,7 @@ enum OutputType
 enum SourceType
 {
    SOURCE_ASM,
+   SOURCE_archive,
    SOURCE_C,
    SOURCE_DS,
    SOURCE_object,
@@ -0,0 +1,412 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright(C) 2014 David Hill
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+//-----------------------------------------------------------------------------
+//
+// Synthetic source generator start point.
+//
+// Writes a DS or C program of a requested size, for measuring how the
+// compiler's time and memory grow with each dimension of its input. Every
+// dimension has its own option, so one can be scaled while the others stay
+// fixed.
+//
+//-----------------------------------------------------------------------------
+
+#include "../option.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+
+//----------------------------------------------------------------------------|
+// Types                                                                      |
+//
+
+//
+// Language
+//
+enum Language
+{
+   LANG_C,
+   LANG_DS,
+};
+
+
+//----------------------------------------------------------------------------|
+// Static Variables                                                           |
+//
+
+static option::option_data<int> option_cases
+('\0', "cases", "generation",
+ "Sets the number of cases in each function's switch. 16 by default.",
+ NULL, 16);
+
+static option::option_data<int> option_depth
+('\0', "depth", "generation",
+ "Sets how deeply blocks are nested in each function. 4 by default.",
+ NULL, 4);
+
+static option::option_data<int> option_enumerators
+('\0', "enumerators", "generation",
+ "Sets the number of enumerators in the enum. 100 by default.", NULL, 100);
+
+static option::option_data<int> option_functions
+('\0', "functions", "generation",
+ "Sets the number of functions. 100 by default.", NULL, 100);
+
+static option::option_data<int> option_globals
+('\0', "globals", "generation",
+ "Sets the number of file scope variables. 100 by default.", NULL, 100);
+
+static option::option_data<std::string> option_lang
+('\0', "lang", "generation",
+ "Sets the language to write, ds or c. ds by default.", NULL, "ds");
+
+static option::option_data<int> option_macros
+('\0', "macros", "generation",
+ "Sets the number of function-like macros. Each expands to about the log of "
+ "its index in others. 100 by default.", NULL, 100);
+
+static option::option_data<int> option_members
+('\0', "members", "generation",
+ "Sets the number of members in each structure. 16 by default.", NULL, 16);
+
+static option::option_data<std::string> option_out
+('o', "out", "output",
+ "Indicates a file to write to. stdout by default.", NULL);
+
+static option::option_data<int> option_strings
+('\0', "strings", "generation",
+ "Sets the number of distinct string literals, spread over the functions. "
+ "100 by default.", NULL, 100);
+
+static option::option_data<int> option_structs
+('\0', "structs", "generation",
+ "Sets the number of structure types, each pointing to the one before. 10 "
+ "by default.", NULL, 10);
+
+static Language Lang;
+
+
+//----------------------------------------------------------------------------|
+// Static Functions                                                           |
+//
+
+//
+// BlockEnd
+//
+// DS statement blocks are terminated like any other statement.
+//
+static char const *BlockEnd()
+{
+   return Lang == LANG_DS ? "};" : "}";
+}
+
+//
+// Indent
+//
+static void Indent(std::ostream *out, int depth)
+{
+   for(int i = depth * 3; i--;) *out << ' ';
+}
+
+//
+// WriteEnum
+//
+static void WriteEnum(std::ostream *out)
+{
+   if(option_enumerators.data <= 0) return;
+
+   *out << "enum E\n{\n";
+
+   for(int i = 0; i != option_enumerators.data; ++i)
+      *out << "   E" << i << ",\n";
+
+   *out << "};\n\n";
+}
+
+//
+// WriteFunction
+//
+static void WriteFunction(std::ostream *out, int index)
+{
+   int const depth   = option_depth.data;
+   int const members = option_members.data;
+   int const structs = option_structs.data;
+
+   if(Lang == LANG_DS)
+      *out << "__intfunc int f" << index << "(int x)\n{\n";
+   else
+      *out << "static int f" << index << "(int x)\n{\n";
+
+   // Structure local.
+   if(structs > 0 && members > 0)
+   {
+      *out << (Lang == LANG_DS ? "   S" : "   struct S") << index % structs
+           << " s;\n";
+
+      for(int i = 0; i != members; ++i)
+         *out << "   s.m" << i << " = x + " << i << ";\n";
+
+      *out << "   x += s.m" << index % members << ";\n";
+   }
+
+   // Nested blocks, each with a local using the enclosing ones.
+   for(int i = 1; i <= depth; ++i)
+   {
+      Indent(out, i);
+      *out << "{\n";
+      Indent(out, i + 1);
+      if(i == 1)
+         *out << "int v1 = x";
+      else
+         *out << "int v" << i << " = v" << i - 1;
+
+      if(option_macros.data > 0)
+         *out << " + M" << (index + i) % option_macros.data << "(x)";
+      if(option_globals.data > 0)
+         *out << " + g" << (index * depth + i) % option_globals.data;
+
+      *out << ";\n";
+   }
+
+   if(depth > 0)
+   {
+      Indent(out, depth + 1);
+      *out << "x = v" << depth << ";\n";
+   }
+
+   for(int i = depth; i >= 1; --i)
+   {
+      Indent(out, i);
+      *out << BlockEnd() << '\n';
+   }
+
+   // Switch over a dense range, with the last case far off.
+   if(option_cases.data > 0)
+   {
+      *out << "   switch(x & 0xFF)\n   {\n";
+
+      for(int i = 0; i != option_cases.data; ++i)
+      {
+         *out << "   case " << (i + 1 == option_cases.data ? i * 16 : i) << ": x ";
+
+         if(option_enumerators.data > 0)
+            *out << "+= E" << (index + i) % option_enumerators.data;
+         else
+            *out << "+= " << i;
+
+         *out << "; break;\n";
+      }
+
+      *out << "   default: x -= 1; break;\n   " << BlockEnd() << '\n';
+   }
+
+   // Strings, spread evenly.
+   if(option_strings.data > 0 && option_functions.data > 0)
+   {
+      for(int i = index; i < option_strings.data; i += option_functions.data)
+         *out << "   str = \"string literal " << i << "\";\n";
+   }
+
+   if(option_globals.data > 0)
+      *out << "   g" << index % option_globals.data << " += x;\n";
+
+   if(index)
+      *out << "   return x + f" << index - 1 << "(x >> 1);\n";
+   else
+      *out << "   return x;\n";
+
+   *out << BlockEnd() << "\n\n";
+}
+
+//
+// WriteGlobals
+//
+static void WriteGlobals(std::ostream *out)
+{
+   for(int i = 0; i != option_globals.data; ++i)
+      *out << "static int g" << i << ";\n";
+
+   *out << "static char const *str;\n\n";
+}
+
+//
+// WriteMacros
+//
+static void WriteMacros(std::ostream *out)
+{
+   if(option_macros.data <= 0) return;
+
+   *out << "#define M0(x) (x)\n";
+
+   for(int i = 1; i != option_macros.data; ++i)
+      *out << "#define M" << i << "(x) ((x) * " << i << " + M" << i / 2 << "(x))\n";
+
+   *out << '\n';
+}
+
+//
+// WriteScript
+//
+static void WriteScript(std::ostream *out)
+{
+   if(Lang == LANG_DS)
+      *out << "__script void Main() __enter\n{\n";
+   else
+      *out << "void Main(void) __attribute__((__script__(enter)))\n{\n";
+
+   if(option_functions.data > 0)
+      *out << "   f" << option_functions.data - 1 << "(0);\n";
+
+   *out << BlockEnd() << '\n';
+}
+
+//
+// WriteStructs
+//
+static void WriteStructs(std::ostream *out)
+{
+   for(int i = 0; i != option_structs.data; ++i)
+   {
+      *out << "struct S" << i << "\n{\n";
+
+      for(int j = 0; j != option_members.data; ++j)
+         *out << "   int m" << j << ";\n";
+
+      if(i)
+         *out << (Lang == LANG_DS ? "   S" : "   struct S") << i - 1 << " *next;\n";
+
+      *out << "};\n\n";
+   }
+}
+
+//
+// WriteSource
+//
+static void WriteSource(std::ostream *out)
+{
+   *out << "// Generated by srcgen: --lang " << option_lang.data
+        << " --functions " << option_functions.data
+        << " --globals " << option_globals.data
+        << " --depth " << option_depth.data
+        << " --enumerators " << option_enumerators.data
+        << " --cases " << option_cases.data
+        << " --macros " << option_macros.data
+        << " --members " << option_members.data
+        << " --structs " << option_structs.data
+        << " --strings " << option_strings.data << "\n\n";
+
+   WriteMacros(out);
+   WriteEnum(out);
+   WriteStructs(out);
+   WriteGlobals(out);
+
+   for(int i = 0; i < option_functions.data; ++i)
+      WriteFunction(out, i);
+
+   WriteScript(out);
+}
+
+//
+// _init
+//
+static void _init(int argc, char const *const *argv)
+{
+   option::help_program = argv[0];
+   option::help_usage   = "[option]...";
+   option::help_desc_s  = "Writes a synthetic DS or C program for benchmarking.";
+
+   option::process_options(argc-1, argv+1, option::OPTF_KEEPA);
+
+   if(option::option_args::arg_count)
+   {
+      option::print_help(stderr);
+      throw 1;
+   }
+
+   if(option_lang.data == "ds")
+      Lang = LANG_DS;
+   else if(option_lang.data == "c")
+      Lang = LANG_C;
+   else
+   {
+      std::cerr << "Unknown language '" << option_lang.data << "'.\n";
+      throw 1;
+   }
+}
+
+//
+// _main
+//
+static int _main()
+{
+   if(option_out.data.empty())
+   {
+      WriteSource(&std::cout);
+      return 0;
+   }
+
+   std::ofstream out(option_out.data.c_str());
+
+   if(!out)
+   {
+      std::cerr << "Failed to open '" << option_out.data << "' for writing.\n";
+      return EXIT_FAILURE;
+   }
+
+   WriteSource(&out);
+
+   return 0;
+}
+
+
+//----------------------------------------------------------------------------|
+// Global Functions                                                           |
+//
+
+//
+// main
+//
+int main(int argc, char *argv[])
+{
+   try
+   {
+      _init(argc, argv);
+
+      return _main();
+   }
+   catch(option::exception const &e)
+   {
+      std::cerr << "(option::exception): " << e.what() << std::endl;
+      option::print_help(stderr);
+   }
+   catch(std::exception const &e)
+   {
+      std::cerr << e.what() << std::endl;
+   }
+   catch(int e)
+   {
+      return e;
+   }
+
+   return EXIT_FAILURE;
+}
+
+// EOF
+